@@ -0,0 +1,94 @@
+#include "mono2025.h"
+#include "inspection.h"
+
+// 1項目の呼び出し回数
+const word BENCH_CALLS = 1000;
+// taskRun() を回す時間 [ms]
+const word BENCH_TASK_MS = 1000;
+// probeClock() を前後で呼ぶだけのクロック数 (各値から引く)
+static unsigned long bench_overhead = 0;
+
+// 1回ずつ計り、"名前,回数,最小,平均,最大" の行を出す (クロック数は割り込みの時間も含む)
+// calls 回か ms [ms] 経つまで body(i) を呼ぶ
+template<typename F> void bench(const __FlashStringHelper *name, const word calls, const word ms, F body) {
+  // 送信の割り込みを計測に入れない
+  Serial.flush();
+  unsigned long lo = 0xFFFFFFFF, hi = 0, sum = 0;
+  word i = 0;
+  const unsigned long begin = millis();
+  for (; i < calls && millis() - begin < ms; i++) {
+    const unsigned long from = probeClock();
+    body(i);
+    const unsigned long to = probeClock();
+    const unsigned long cycles = to - from > bench_overhead ? to - from - bench_overhead : 0;
+    lo = min(lo, cycles);
+    hi = max(hi, cycles);
+    sum += cycles;
+  }
+  const float mean = i ? (float) sum / i : 0.0f;
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(i);
+  Serial.print(',');
+  Serial.print(i ? lo : 0);
+  Serial.print(',');
+  Serial.print(mean, 1);
+  Serial.print(',');
+  Serial.println(hi);
+}
+
+// 全項目を順に計る (行の並びと名前は変えない)
+void benchmark() {
+  Serial.println(F("benchmark,begin"));
+  Serial.println(F("name,calls,cycles_min,cycles_mean,cycles_max"));
+  const unsigned long begin = millis();
+  // 計測そのものの時間
+  bench_overhead = 0;
+  unsigned long overhead = 0xFFFFFFFF;
+  for (byte i = 0; i < 100; i++) {
+    const unsigned long from = probeClock();
+    overhead = min(overhead, probeClock() - from);
+  }
+  bench_overhead = overhead;
+  // 同じ値では何もしない関数があるので、毎回違う値を渡す
+  bench(F("matrix"), BENCH_CALLS, 0xFFFF, [](word i) { matrix(i & 1 ? mt::UP : mt::DOWN); });
+  bench(F("matrix_reset"), BENCH_CALLS, 0xFFFF, [](word) { matrix_reset(); });
+  bench(F("bar"), BENCH_CALLS, 0xFFFF, [](word i) { bar(lineIndex[i % 10], rgbIndex[i % 8]); });
+  bench(F("seg"), BENCH_CALLS, 0xFFFF, [](word i) { seg(num[i % 10]); });
+  bench(F("mode"), BENCH_CALLS, 0xFFFF, [](word i) { mode(i & 1); });
+  // 待たずに戻るので呼び出しだけ (歩みは Timer3 の割り込み)
+  bench(F("stepper"), BENCH_CALLS, 0xFFFF, [](word) { stepper(); });
+  stepperStop();
+  bench(F("dc"), BENCH_CALLS, 0xFFFF, [](word i) { dc(i & 1 ? RT : S); });
+  dc(S);
+  bench(F("syncPot"), BENCH_CALLS, 0xFFFF, [](word) { syncPot(); });
+  bench(F("syncArrow"), BENCH_CALLS, 0xFFFF, [](word) { syncArrow(); });
+  bench(F("isTactPressed"), BENCH_CALLS, 0xFFFF, [](word) { isTactPressed(TL); });
+  bench(F("isPhotoPassed"), BENCH_CALLS, 0xFFFF, [](word) { isPhotoPassed(); });
+  // Inspector と同じタスクを回した loop() の1周 (入力は実機の操作、シミュレーターでは Benchmark/scenarios のスクリプト)
+  bench(F("taskRun"), 0xFFFF, BENCH_TASK_MS, [](word) { taskRun(); });
+  // 元に戻す
+  dc(S);
+  stepperStop();
+  buzzStop();
+  bar();
+  seg();
+  matrix();
+  Serial.print(F("benchmark,end,"));
+  Serial.println(millis() - begin);
+}
+
+void start() {
+  Serial.begin(115200);
+  // Inspector のタスクを登録 (taskRun() の行でだけ動く)
+  inspectionBegin();
+}
+
+// 起動時と、シリアルで何か受け取る度に計る
+void loop() {
+  static boolean done = false;
+  if (done && !Serial.available()) return;
+  while (Serial.available()) Serial.read();
+  benchmark();
+  done = true;
+}
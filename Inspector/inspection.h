@@ -0,0 +1,104 @@
+/*
+  Copyright 2025 Syuugo
+  
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 検証用プログラムのタスク (Inspector と Benchmark で同じ物を使う)
+// start() で inspectionBegin() を呼び、loop() で taskRun() を呼ぶ。
+
+#ifndef INSPECTION_H
+#define INSPECTION_H
+
+#include "mono2025.h"
+
+// LEDバーの位置 (列挙型変数要参照)
+static byte bar_gage = 1;
+// LEDバーの色 (列挙型変数要参照)
+static byte bar_color = 1;
+// サーボモーターの角度
+static byte pos = SERVO_MIN;
+// サーボの１ステップ
+const byte SERVO_STEP = 8;
+
+// モーター (5ms 毎。stepper() は 10ms 以内に呼び続ける)
+void inspectMotor() {
+  // トグルが下向きの時
+  if (!isToggleEnabled()) {
+    // DCモーターをストップ
+    dc(S);
+  // トグルが上向きの時
+  } else {
+    // DCモーターを右回転
+    dc(RT);
+    // ステッピングモーターを右回転
+    stepper();
+  }
+}
+
+// スイッチ (10ms 毎)
+void inspectSwitch() {
+  // 自作基盤上の右から２番目のタクトが押された時
+  if (isTactPressed(RL) && bar_gage > 1) {
+    // LEDバーの位置を下げる
+    bar_gage--;
+    // ブザー中音鳴動
+    buzz(MI, 0.2);
+  // 自作基盤上の右端のタクトが押された時
+  } else if (isTactPressed(RR) && bar_gage < 10) {
+    // LEDバーの位置を上げる
+    bar_gage++;
+    // ブザー高音鳴動
+    buzz(HI, 0.2);
+  }
+  // 自作基盤上の左端のタクトが押された時
+  if (isTactPressed(LL) && bar_color > 1) {
+    // LEDバーの色を一つ前に戻す
+    bar_color--;
+    // ブザー中音鳴動
+    buzz(MI, 0.2);
+  // 自作基盤上の左から２番目のタクトが押された時
+  } else if (isTactPressed(LR) && bar_color < 8) {
+    // LEDバーの色を一つ進める
+    bar_color++;
+    // ブザー高音鳴動
+    buzz(HI, 0.2);
+  }
+  // サーボ角度増加（大会基盤上の左側のタクトが押された時）
+  if (isTactPressed(TL) && pos < SERVO_MAX) pos += SERVO_STEP;
+  // サーボ角度減少（大会基盤上の右側のタクトが押された時）
+  if (isTactPressed(TR) && pos > SERVO_MIN) pos -= SERVO_STEP;
+  // サーボ適用
+  servo(pos);
+  // フォトインタラプタ遮蔽時にブザー低音鳴動
+  if (isPhotoEnabled()) buzz(LO, 0.3);
+}
+
+// 表示 (50ms 毎)
+void inspectDisplay() {
+  // トグルが下向きの時、7セグと半固定抵抗を同期
+  if (!isToggleEnabled()) syncPot();
+  // LEDバー点灯
+  bar(lineIndex[bar_gage - 1], rgbIndex[bar_color - 1]);
+  // LEDマトリックスとジョイスティックを同期
+  syncArrow();
+}
+
+// サーボを初期位置に戻し、周期 [ms] と優先度を決めて登録
+void inspectionBegin() {
+  // サーボモーターを初期位置に移動
+  servo(SERVO_MIN);
+  taskAdd(inspectMotor, 5, 3);
+  taskAdd(inspectSwitch, 10, 2);
+  taskAdd(inspectDisplay, 50, 1);
+}
+
+#endif // INSPECTION_H
@@ -23,25 +23,47 @@
  * 
  * ・stepper(reverse)
  *   ステッピングモーター制御関数
- *   3°ずつ動く。
+ *   3°ずつ動く。呼ばれ続けている間は 100 steps/s で回り続け、待たされる事は無い。
  *   引数なしでは時計回りに動く。
  *   引数の reverse を true にすると、反時計回りに動く。
  * 
+ * ・stepperMoveTo(position), stepperMoveBy(steps), stepperRun(reverse), stepperStop()
+ *   ステッピングモーターを台形加減速で動かす。呼び出しはすぐに戻る。
+ *   位置は stepperPosition() で取得でき、isStepperMoving() で動作中か分かる。
+ *   stepperSpeed(speed, accel) で最高速度 [steps/s] と加速度 [steps/s^2] を設定する。
+ *   stepperMode(mode) で励磁方式を PHASE_1 (1相), PHASE_2 (2相), PHASE_1_2 (1-2相) から選ぶ。
+ *   各方式の駆動パターンは STEPPER_PATTERNS, STEPPER_PATTERNS_TWO, STEPPER_PATTERNS_HALF (フラッシュ上、従来通り [i][j] で読める)。
+ * 
  * ・dc(action)
  *   DCモーターを制御する。
  *   action には、RT(Right Turn：右回り)、LT(Left Turn：左回り)、S(Stop：即停止)、F(Free：減速)がある。
  *   aciton の文字にダブルクォーテーションは不要。
  * 
+ * ・dcPower(action, duty), dcSpeed(action, rpm)
+ *   DCモーターを出力を絞って (duty は 0〜255)、または回転数 [rpm] を指定して回す。
+ *   回転数はフォトインタラプタの回転計で測り、PID 制御で保つ。dc() を呼ぶと解除される。
+ *   isDcSettled() で目標に落ち着いたか、dcSettleTime() でそれまでの時間 [ms]、
+ *   dcSpeedError() で定常偏差 [rpm] が分かる。ゲインは dcTune(kp, ki, kd) で変更する。
+ * 
  * ・buzz(level, duration)
  *   ブザー鳴動関数。
  *   level は周波数で、HI(高音)、MI(中音)、LO(低音)がある。
  *   これらにダブルクォーテーションは不要。
  +   特定の周波数を数値で直接入れることも可能。
  *   音の長さは２つ目の引数である duration に秒数で入れる。小数第一位まで対応。
+ *   音は割り込みで鳴らすので待たない。鳴っている音と同じ音を続けて呼んでも鳴らし直さず、違う音は順番に鳴る。
+ * 
+ * ・buzzPlay(sound), buzzStop(), isBuzzing()
+ *   PROGMEM の効果音 (sfx::CLICK, OK, NG, ARPEGGIO, ALARM) を待ち行列に積んで鳴らす。
+ *   note(hz, ms, ENV_DECAY) と rest(ms) の配列を sound(notes, priority, repeat) で効果音にできる。
+ *   優先度 (BUZZ_LOW, NORMAL, HIGH) が高い音は今の音を止めて鳴る。音量の変化は ENV_FLAT, DECAY, SWELL。
  * 
  * ・servo(angle)
  * 　サーボモーター制御関数。
  * 　引数には何度の位置まで移動させるかを入れる。(8〜160)
+ * 　割り込みが 50Hz で台形の速度 (既定は最高 240°/s、加速度 1200°/s^2) で滑らかに動かす。
+ * 　servoTune(max_speed, acceleration) で変更、0 で即座に動く。isServoReached() で着いたか分かる。
+ * 　servoMicroseconds(us) でパルス幅を直接目標にすることもできる。
  * 
  * ・seg(mask)
  *   7セグ制御関数。
@@ -55,8 +77,25 @@
  * 　LEDマトリックス制御関数。
  * 　pattern に次の定数を入れる
  * 　mt::[UP, DOWN, LEFT, RIGHT], mt::[LEFT, UP]_[1-8]
+ * 　(フラッシュ上の Glyph。従来通り mt::UP[i] で列を読めるが、byte* としては渡せないので memcpy_P で写す)
  * 　または、byte[8] で自作のデザインを作る。
+ * 　描画はタイマー割り込みで常時行われるので、表示を変える時だけ呼べば良い。
+ * 
+ * ・matrixChar(c), matrixScroll(F("text"), column_ms, repeat), matrixPlay(frames, frame_ms, repeat)
+ * 　1文字の表示、フラッシュ上の文字列の横スクロール、PROGMEM の Glyph 配列のコマ送りを行う。
+ * 　再生は割り込みで一定の速さで進み、isMatrixPlaying() で再生中か分かる。matrix() 等を呼ぶと止まる。
+ * 　図柄は glyph("...##...", ...) で上の行から8行の文字列として書ける。（'.' 以外が点灯）
+ * 　例：const Glyph FRAMES[] PROGMEM = { glyph(...), glyph(...) };
  * 
+ * ・matrixBack(), matrixSwap()
+ * 　書き込み用の面を直接編集し、次のフレームから表示する。
+ * 　SER, SRCLK, RCLK のピンは割り込みが使用するので、直接操作しない。
+ *
+ * ・matrixPixel(x, y, level), matrixGrayFill(level), matrixGrayShow(), matrixBrightness(level)
+ * 　1点ずつ 0〜15 の16段階の明るさで描き、matrixGrayShow() で次のフレームから表示する。
+ * 　matrixBrightness() は全体の明るさ (0〜255) で、点灯時間だけを削るので走査の周期 (250Hz) は変わらない。
+ * 　階調も割り込みで作るので、loop() が重くても明るさは変わらない。
+ *
  * ・bar(line, color)
  * 　LEDバー制御関数。
  * 　line には、P[1-10] を入れる。
@@ -64,12 +103,22 @@
  *   lineIndex[] で上から下に加算、lineBottomIndex[] で下から上に加算。
  * 　color は、R,G,B,W,C,Y,M,K を入れる。
  * 
+ * ・barColor(line, rgb(r, g, b)), barFade(line, color, ms), barGradient(top, bottom, ms), isBarFading()
+ * 　各線を 24bit の色 (rgb(0xFF8000) とも書ける) で光らせる。赤・緑は Timer4 の PWM、青は割り込みで作る。
+ * 　色ごとに線を時分割 (200Hz) で点灯するので、1本の明るさは bar() の 1/10 になる。bar() を呼ぶと止まる。
+ * 　フェードとグラデーションの変化は割り込みで進むので、呼ぶのは変える時だけで良い。
+ * 
  * ・isPhotoEnabled()
  *   フォトインタラプタが遮断されている間 true を返す。
  * 
  * ・isPhotoPassed(rotation)
  *   羽が引数に指定した回数通過した瞬間 true を返す。
  * 
+ * ・tachRpm(), tachAverageRpm(), tachJitter(), isTachStalled()
+ *   フォトインタラプタを回転計として使う。羽が遮る度に割り込みで周期を測っている。
+ *   直前の1周期と平均の回転数 [rpm]、周期のばらつき [us]、停止中 (0.5秒羽が来ない) かを返す。
+ *   羽が複数枚ある時は tachBlades(blades) で枚数を設定する。時刻の分解能は 100us。
+ * 
  * ・isToggleEnabled()
  *   トグルスイッチが上向きの状態なら true を返す。
  * 
@@ -85,88 +134,394 @@
  *   タクトスイッチが押された一瞬のみ true を返す。
  *   引数は Enabled 版と同じ。
  * 
+ * ・isPhotoPassed, isTogglePulled, isTactPressed の変化は割り込みで記録されるので、
+ *   呼び出しの間隔が空いても取りこぼさない。（押された回数だけ true を返す）
+ *   inputNext(event) で時刻付きの変化点を直接取り出す事もできる。（その分は上記の関数に数えられない）
+ * 
  * ・syncPot()
  * 　7セグと半固定抵抗の値を同期する。
  * 
  * ・syncArrow()
  * 　LEDマトリックスとジョイスティックの値を同期する。
+ * 
+ * ・getPot(), getJoyX(), getJoyY()
+ *   割り込みで常に読み取り、平滑化した値 (0〜1023) を待たずに返す。
+ *   これらのピンに analogRead は使わない。
+ * 
+ * ・taskAdd(function, period_ms, priority, deadline_ms), taskRun()
+ *   処理ごとに周期と優先度を決めて登録し、loop() で taskRun() を呼ぶ。周期と期限は 65535ms まで。
+ *   時刻が来たタスクのうち優先度の高いものを1つ実行し、何も無ければ false を返す。（空き時間に使える）
+ *   task(id) で実行回数・期限超過の回数・遅れ・実行時間、taskJitter(id) で遅れの平均 [us]、
+ *   taskIdle() でタスクを実行していない時間の割合 [%] が分かる。
+ * 
+ * ・telemetryBegin(period_ms, baud), telemetryStream(on), telemetryDropped()
+ *   シリアルを開き直し (既定は 1Mbaud)、period_ms 毎 (既定は 10ms) に入力・表示・モーターの状態を
+ *   番号と時刻付きのバイナリのフレームで送るタスクを登録する。送信バッファに空きが無い時は待たずに捨てて数える。
+ *   telemetryStream(false) で止めておけば、コマンドの応答や自己診断の CSV にフレームが混ざらない。
+ *   受け取ったデータは tools/telemetry_decode で CSV に変換できる。（番号の抜けで取りこぼしが分かる）
+ * 
+ * ・selfTest(out, automatic), isSelfTestRequested()
+ *   全部の部品を同時に動かして自己診断し、項目ごとの合否・開始時刻・かかった時間 [ms]・測った値を CSV で出力する。
+ *   AD 変換の揺れとジョイスティックの中央、各タクトの押下、DC モーターで回した羽のフォトインタラプタ、
+ *   ステッピングモーターの往復、サーボの端から端、マトリックス・LEDバーの割り込み、7セグ、ブザーを確かめる。
+ *   終わるまで戻らない。automatic を true にするとタクトの項目は skip になる。
+ *   isSelfTestRequested() は大会基盤の左右のタクトが同時に押されている間 true を返す。
+ * 
+ * ・commandService()
+ *   loop() で呼んでおくと、シリアルから改行で区切ったコマンドを受けて実行し、最後に ok,名前 か error,名前 を返す。
+ *   hello (版の確認)、test (自己診断、test auto でタクトを飛ばす)、probe (計測の表)、reset (計測とタスクの統計を消す)、
+ *   telemetry on/off (テレメトリーの開始・停止。stream 1/0 でも良い)。t, p, r の1文字でも良い。
+ *   trace record / trace stop (入力の変化点を記録して送る)、trace replay (送られた変化点を同じ時刻で再生)。
+ *   記録は実機の入力 (ピンと AD 変換値) の変化だけを 100us 単位で残すので、tools/trace_tool でファイルにして、
+ *   後で別の基板やシミュレーターで同じ操作を繰り返せる。
+ *   tools/inspect_boards で複数の基板に同時に自己診断をさせて結果をまとめられる。
+ * 
+ * ・#define MONO_PROBES (インクルードの前)
+ *   stepper, dc, seg, matrix, bar, syncPot, syncArrow, servo, buzz と MONO_PROBE(PROBE_LOOP) を置いた所の
+ *   実行時間を 62.5ns 単位で計り、最小・平均・最大と度数分布を集計する。（割り込みの時間も含む）
+ *   commandService() を loop() で呼んでおくと、シリアルで p を送ると表を出力、r で集計を消す。
+ *   定義しなければ計測のコードは何も生成されない。
+ * 
+ * ・#define MONO_PROFILE (MONO_BAR | MONO_MATRIX) (インクルードの前)
+ *   使う部品を MONO_BAR, MATRIX, SEG, STEPPER, DC, BUZZER, SERVO, INPUT (タクト・トグル・フォトインタラプタ), ADC の和で指定する。
+ *   使わない部品はピンの設定・割り込み・タイマー・表・変数が何も生成されない。(SERVO が無ければ Servo も Timer5 も使わない)
+ *   selfTest() の項目、テレメトリーの欄、コマンドの trace も同じで、使わない部品の分は skip や 0、error になる。
+ *   Timer4 (システムタイマー) だけはどの構成でも使う。(ticks()・taskRun() の時刻の元)
+ *   既定は MONO_ALL。コードでは isUsed(MONO_SEG) 等で分けられる。
+ *   使わない部品の関数は呼ばない。(初期化されていないので動かない)
+ * 
+ * ・busSplit(motor_percent)
+ *   7セグとモーターが共有する線のうち、モーターに割り当てる時間を 0〜100% で設定する。
+ *   0 (初期値) ではモーターの状態が変わった時だけドライバーにラッチさせ、それ以外は 7セグを表示する。
+ *   MODE_PIN, SEG_MODE_PIN は割り込みが使用するので、直接操作しない。
+ * 
+ * ・outputBegin(), outputCommit()
+ *   間の bar() 等の出力を下書きに集め、outputCommit() で前と変わったビットだけをポート毎に1回で出力する。
+ *   taskRun() はタスク毎に自動で囲むので、タスクの途中の中途半端な状態は線に出ない。囲まなければすぐ出力される。
+ *   7セグ・モーターの共有線は割り込みが窓を切り替えて出すので下書きは使わず、値が変わらなければ線に触らない。
+ * 
+ * ・*_PIN.write(value), *_PIN.high(), *_PIN.low(), *_PIN.read()
+ *   ピンをレジスタで直接読み書きする。digitalWrite より高速。
+ *   pinMode 等には従来通りピン番号として渡せる。
  */
 
 #ifndef MONO2025_H
 #define MONO2025_H
 
+// 部品 (使う物を足し合わせてインクルードの前に MONO_PROFILE に定義する。既定は全部)
+#define MONO_BAR     0x001
+#define MONO_MATRIX  0x002
+#define MONO_SEG     0x004
+#define MONO_STEPPER 0x008
+#define MONO_DC      0x010
+#define MONO_BUZZER  0x020
+#define MONO_SERVO   0x040
+#define MONO_INPUT   0x080
+#define MONO_ADC     0x100
+#define MONO_ALL     0x1FF
+// 7セグとモーターが共有する線
+#define MONO_BUS     (MONO_SEG | MONO_STEPPER | MONO_DC)
+#ifndef MONO_PROFILE
+#define MONO_PROFILE MONO_ALL
+#endif
+
+#if MONO_PROFILE & MONO_SERVO
 #include <Servo.h> // lib/Servo
+#endif
+#include <util/crc16.h>
 
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 
+/*************
+ * 部品の構成 *
+ *************/
+
+// MONO_PROFILE をコードから参照する (if の条件はコンパイル時に決まり、使わない部品の処理は生成されない)
+// 割り込みとライブラリのように宣言そのものを消す所だけ #if MONO_PROFILE & ... で分ける
+constexpr word PROFILE = MONO_PROFILE;
+static_assert(PROFILE && !(PROFILE & ~MONO_ALL), "MONO_PROFILE は MONO_BAR 等の和");
+
+// parts のどれかを使うなら true
+constexpr boolean isUsed(const word parts) {
+  return PROFILE & parts;
+}
+
+/*****************
+ * フラッシュの表 *
+ *****************/
+
+// 定数の表は PROGMEM でフラッシュに置き、起動時に SRAM (8KB) へコピーさせない
+// 元の配列は flash:: に置き、同じ名前の FlashTable から添字で読む
+
+// 1要素を読み出す (1, 2 バイトは lpm 命令で直接)
+inline byte flashRead(const byte *p) { return pgm_read_byte(p); }
+inline char flashRead(const char *p) { return pgm_read_byte(p); }
+inline word flashRead(const word *p) { return pgm_read_word(p); }
+template<typename T> inline T flashRead(const T *p) {
+  T value;
+  memcpy_P(&value, p, sizeof(T));
+  return value;
+}
+
+// フラッシュ上の配列 (従来の配列と同じく table[i] で読める)
+template<typename T, byte N> struct FlashTable {
+  const T *data;
+  inline T operator[](const byte i) const { return flashRead(data + i); }
+  static constexpr byte size() { return N; }
+};
+template<typename T, size_t N> constexpr FlashTable<T, N> flashTable(const T (&data)[N]) {
+  return { data };
+}
+
+/*****************
+ * ポート直接制御 *
+ *****************/
+
+// digitalWrite はピン毎に表とタイマーを調べるため、固定ピンはレジスタを直接操作する
+namespace io {
+  // Mega 2560 のピン番号 (0〜69) に対応するポートとビット
+  constexpr char PIN_PORT[] = "EEEEGEHHHHBBBBJJHHDDDDAAAAAAAACCCCCCCCDGGGLLLLLLLLBBBBFFFFFFFFKKKKKKKK";
+  constexpr char PIN_BIT[] = "0145533456456710103210012345677654321072107654321032100123456701234567";
+
+  // ポートのレジスタ (A〜G は sbi/cbi で1ビットを不可分に書き換えられる)
+  template<char X> struct Port;
+#define MONO_PORT(X) \
+  template<> struct Port<#X[0]> { \
+    static const boolean SBI = #X[0] <= 'G'; \
+    static inline decltype((PORT##X)) out() { return PORT##X; } \
+    static inline decltype((DDR##X)) dir() { return DDR##X; } \
+    static inline decltype((PIN##X)) in() { return PIN##X; } \
+  }
+  MONO_PORT(A); MONO_PORT(B); MONO_PORT(C); MONO_PORT(D); MONO_PORT(E); MONO_PORT(F);
+  MONO_PORT(G); MONO_PORT(H); MONO_PORT(J); MONO_PORT(K); MONO_PORT(L);
+#undef MONO_PORT
+
+  // 割り込みを止めて複数ビットを書き換える (mask が全ビットなら代入のみ)
+  template<char X> inline void assign(const byte mask, const byte bits) {
+    if (mask == 0xFF) {
+      Port<X>::out() = bits;
+    } else {
+      const byte sreg = SREG;
+      cli();
+      Port<X>::out() = (Port<X>::out() & ~mask) | bits;
+      SREG = sreg;
+    }
+  }
+
+  // ピン群 N... のうちポート X に属するビット (値の bit0 が先頭のピン)
+  template<char X, byte... N> struct PortBits;
+  template<char X> struct PortBits<X> {
+    static constexpr byte mask() { return 0; }
+    static inline byte bits(const word) { return 0; }
+  };
+  template<char X, byte N, byte... Rest> struct PortBits<X, N, Rest...> {
+    static constexpr byte mine() { return PIN_PORT[N] == X ? 1 << (PIN_BIT[N] - '0') : 0; }
+    static constexpr byte mask() { return mine() | PortBits<X, Rest...>::mask(); }
+    static inline byte bits(const word value) { return ((value & 1) ? mine() : 0) | PortBits<X, Rest...>::bits(value >> 1); }
+  };
+
+  // ポート X の出力の下書き (mask のビットを bits に。outputCommit() で反映する)
+  template<char X> struct Frame {
+    static byte mask;
+    static byte bits;
+  };
+  template<char X> byte Frame<X>::mask = 0;
+  template<char X> byte Frame<X>::bits = 0;
+
+  // 下書きと違うビットだけを PINx への書き込みで反転 (1命令なので他のビットを触る割り込みと競合しない)
+  template<char X> inline void commit() {
+    const byte mask = Frame<X>::mask;
+    if (!mask) return;
+    Frame<X>::mask = 0;
+    const byte changed = (Port<X>::out() ^ Frame<X>::bits) & mask;
+    if (changed) Port<X>::in() = changed;
+  }
+}
+
+// 1ピン
+template<byte N> struct DigitalPin {
+  static const char PORT = io::PIN_PORT[N];
+  typedef io::Port<PORT> Port;
+  static const byte MASK = 1 << (io::PIN_BIT[N] - '0');
+  // 従来通り pinMode 等にピン番号として渡せる
+  constexpr operator byte() const { return N; }
+  static inline void high() {
+    if (Port::SBI) {
+      Port::out() |= MASK;
+    } else {
+      io::assign<io::PIN_PORT[N]>(MASK, MASK);
+    }
+  }
+  static inline void low() {
+    if (Port::SBI) {
+      Port::out() &= (byte) ~MASK;
+    } else {
+      io::assign<io::PIN_PORT[N]>(MASK, 0);
+    }
+  }
+  static inline void write(const boolean value) {
+    if (value) high(); else low();
+  }
+  // PINx への書き込みで反転 (どのポートでも1命令で不可分)
+  static inline void toggle() {
+    Port::in() = MASK;
+  }
+  static inline boolean read() {
+    return Port::in() & MASK;
+  }
+};
+
+// 複数ピン (同じポートのピンは1回の読み書きでまとめて書き換える)
+template<byte... N> struct PinGroup {
+  // value の bit0 から順に N... へ出力
+  static inline void write(const word value) {
+    put<'A'>(value); put<'B'>(value); put<'C'>(value); put<'D'>(value); put<'E'>(value); put<'F'>(value);
+    put<'G'>(value); put<'H'>(value); put<'J'>(value); put<'K'>(value); put<'L'>(value);
+  }
+  // value のうちポート X に出力する分 (書き込みはしない)
+  template<char X> static inline byte bits(const word value) {
+    return io::PortBits<X, N...>::bits(value);
+  }
+  // 下書きに書く (outputCommit() で変わったビットだけ出力される)
+  static inline void stage(const word value) {
+    draft<'A'>(value); draft<'B'>(value); draft<'C'>(value); draft<'D'>(value); draft<'E'>(value); draft<'F'>(value);
+    draft<'G'>(value); draft<'H'>(value); draft<'J'>(value); draft<'K'>(value); draft<'L'>(value);
+  }
+  // 反映前の下書きを取り消す (割り込みに出力を任せる時)
+  static inline void discard() {
+    io::Frame<'A'>::mask &= ~io::PortBits<'A', N...>::mask(); io::Frame<'B'>::mask &= ~io::PortBits<'B', N...>::mask();
+    io::Frame<'C'>::mask &= ~io::PortBits<'C', N...>::mask(); io::Frame<'D'>::mask &= ~io::PortBits<'D', N...>::mask();
+    io::Frame<'E'>::mask &= ~io::PortBits<'E', N...>::mask(); io::Frame<'F'>::mask &= ~io::PortBits<'F', N...>::mask();
+    io::Frame<'G'>::mask &= ~io::PortBits<'G', N...>::mask(); io::Frame<'H'>::mask &= ~io::PortBits<'H', N...>::mask();
+    io::Frame<'J'>::mask &= ~io::PortBits<'J', N...>::mask(); io::Frame<'K'>::mask &= ~io::PortBits<'K', N...>::mask();
+    io::Frame<'L'>::mask &= ~io::PortBits<'L', N...>::mask();
+  }
+private:
+  template<char X> static inline void put(const word value) {
+    if (io::PortBits<X, N...>::mask()) io::assign<X>(io::PortBits<X, N...>::mask(), io::PortBits<X, N...>::bits(value));
+  }
+  template<char X> static inline void draft(const word value) {
+    const byte mask = io::PortBits<X, N...>::mask();
+    if (!mask) return;
+    io::Frame<X>::mask |= mask;
+    io::Frame<X>::bits = (io::Frame<X>::bits & ~mask) | io::PortBits<X, N...>::bits(value);
+  }
+};
+
+// 下書きを集めている間は true (outputBegin() から outputCommit() まで)
+static boolean output_framing = false;
+
+// 以降の出力を下書きに集める (taskRun() はタスク毎に自動で囲む)
+inline void outputBegin() {
+  output_framing = true;
+}
+
+// 下書きのうち変わったビットだけを、割り込みを挟まずにポート毎1回で出力
+void outputCommit() {
+  const byte sreg = SREG;
+  cli();
+  io::commit<'A'>(); io::commit<'B'>(); io::commit<'C'>(); io::commit<'D'>(); io::commit<'E'>(); io::commit<'F'>();
+  io::commit<'G'>(); io::commit<'H'>(); io::commit<'J'>(); io::commit<'K'>(); io::commit<'L'>();
+  SREG = sreg;
+  output_framing = false;
+}
+
+// 下書きを集めていなければすぐ出力
+inline void outputFlush() {
+  if (!output_framing) outputCommit();
+}
+
 /***********
  * 制御ピン *
  ***********/
 
 // LEDバー
-const byte LED_BAR_1_PIN = 22; // CN1-2
-const byte LED_BAR_2_PIN = 23; // CN1-3
-const byte LED_BAR_3_PIN = 24; // CN1-4
-const byte LED_BAR_4_PIN = 25; // CN1-5
-const byte LED_BAR_5_PIN = 26; // CN1-6
+constexpr DigitalPin<22> LED_BAR_1_PIN {}; // CN1-2
+constexpr DigitalPin<23> LED_BAR_2_PIN {}; // CN1-3
+constexpr DigitalPin<24> LED_BAR_3_PIN {}; // CN1-4
+constexpr DigitalPin<25> LED_BAR_4_PIN {}; // CN1-5
+constexpr DigitalPin<26> LED_BAR_5_PIN {}; // CN1-6
 // ブザー
-const byte BUZZER_PIN = 27; // CN1-7
+constexpr DigitalPin<27> BUZZER_PIN {}; // CN1-7
 // モード切替
-const byte SEG_MODE_PIN = 28; // CN1-8
-const byte MODE_PIN = 29; // CN1-9
+constexpr DigitalPin<28> SEG_MODE_PIN {}; // CN1-8
+constexpr DigitalPin<29> MODE_PIN {}; // CN1-9
 // DCモーター
-const byte DC_MOTOR_1_PIN = 30; // CN2-2 to CN5-2
-const byte DC_MOTOR_2_PIN = 31; // CN2-3 to CN5-1
+constexpr DigitalPin<30> DC_MOTOR_1_PIN {}; // CN2-2 to CN5-2
+constexpr DigitalPin<31> DC_MOTOR_2_PIN {}; // CN2-3 to CN5-1
 // ステッピングモーター
-const byte STEPPER_MOTOR_1_PIN = 32; // CN2-4 to CN6-6
-const byte STEPPER_MOTOR_2_PIN = 33; // CN2-5 to CN6-5
-const byte STEPPER_MOTOR_3_PIN = 34; // CN2-6 to CN6-4
-const byte STEPPER_MOTOR_4_PIN = 35; // CN2-7 to CN6-3
+constexpr DigitalPin<32> STEPPER_MOTOR_1_PIN {}; // CN2-4 to CN6-6
+constexpr DigitalPin<33> STEPPER_MOTOR_2_PIN {}; // CN2-5 to CN6-5
+constexpr DigitalPin<34> STEPPER_MOTOR_3_PIN {}; // CN2-6 to CN6-4
+constexpr DigitalPin<35> STEPPER_MOTOR_4_PIN {}; // CN2-7 to CN6-3
 // 7セグ
-const byte SEG_L1_PIN = STEPPER_MOTOR_1_PIN; // CN2-4
-const byte SEG_L2_PIN = STEPPER_MOTOR_2_PIN; // CN2-5
-const byte SEG_C1_PIN = 37; // CN2-9
-const byte SEG_C2_PIN = DC_MOTOR_2_PIN; // CN2-3
-const byte SEG_C3_PIN = STEPPER_MOTOR_3_PIN; // CN2-6
-const byte SEG_R1_PIN = 36; // CN2-8
-const byte SEG_R2_PIN = STEPPER_MOTOR_4_PIN; // CN2-7
-const byte SEG_POINT_PIN = DC_MOTOR_1_PIN; // CN2-2
+constexpr auto SEG_L1_PIN = STEPPER_MOTOR_1_PIN; // CN2-4
+constexpr auto SEG_L2_PIN = STEPPER_MOTOR_2_PIN; // CN2-5
+constexpr DigitalPin<37> SEG_C1_PIN {}; // CN2-9
+constexpr auto SEG_C2_PIN = DC_MOTOR_2_PIN; // CN2-3
+constexpr auto SEG_C3_PIN = STEPPER_MOTOR_3_PIN; // CN2-6
+constexpr DigitalPin<36> SEG_R1_PIN {}; // CN2-8
+constexpr auto SEG_R2_PIN = STEPPER_MOTOR_4_PIN; // CN2-7
+constexpr auto SEG_POINT_PIN = DC_MOTOR_1_PIN; // CN2-2
 // LED マトリックス
-const byte SER_PIN = 38; // CN3-2 (シリアル入力)
-const byte SRCLK_PIN = 39; // CN3-3 (シフトクロック)
-const byte RCLK_PIN = 40; // CN3-4 (ラッチクロック)
+constexpr DigitalPin<38> SER_PIN {}; // CN3-2 (シリアル入力)
+constexpr DigitalPin<39> SRCLK_PIN {}; // CN3-3 (シフトクロック)
+constexpr DigitalPin<40> RCLK_PIN {}; // CN3-4 (ラッチクロック)
 // サーボモーター
-const byte SERVO_PIN = 41; // CN3-5 to CN7-3
+constexpr DigitalPin<41> SERVO_PIN {}; // CN3-5 to CN7-3
 // LEDバー
-const byte LED_BAR_6_PIN = 2; // CN4-2
-const byte LED_BAR_7_PIN = 3; // CN4-3
-const byte LED_BAR_8_PIN = 4; // CN4-4
-const byte LED_BAR_9_PIN = 5; // CN4-5
-const byte LED_BAR_10_PIN = 6; // CN4-6
-const byte LED_RED_PIN = 7; // CN9-1
-const byte LED_GREEN_PIN = 8; // CN9-3
-const byte LED_BLUE_PIN = 9; // CN9-2
-// 書き込みピン
-const byte PIN_WRITE[] = { LED_RED_PIN, LED_GREEN_PIN, LED_BLUE_PIN, LED_BAR_1_PIN, LED_BAR_2_PIN, LED_BAR_3_PIN, LED_BAR_4_PIN, LED_BAR_5_PIN, LED_BAR_6_PIN, LED_BAR_7_PIN, LED_BAR_8_PIN, LED_BAR_9_PIN, LED_BAR_10_PIN, BUZZER_PIN, MODE_PIN, SEG_MODE_PIN, SEG_L1_PIN, SEG_L2_PIN, SEG_C1_PIN, SEG_C2_PIN, SEG_C3_PIN, SEG_R1_PIN, SEG_R2_PIN, SEG_POINT_PIN, SER_PIN, SRCLK_PIN, RCLK_PIN };
+constexpr DigitalPin<2> LED_BAR_6_PIN {}; // CN4-2
+constexpr DigitalPin<3> LED_BAR_7_PIN {}; // CN4-3
+constexpr DigitalPin<4> LED_BAR_8_PIN {}; // CN4-4
+constexpr DigitalPin<5> LED_BAR_9_PIN {}; // CN4-5
+constexpr DigitalPin<6> LED_BAR_10_PIN {}; // CN4-6
+constexpr DigitalPin<7> LED_RED_PIN {}; // CN9-1
+constexpr DigitalPin<8> LED_GREEN_PIN {}; // CN9-3
+constexpr DigitalPin<9> LED_BLUE_PIN {}; // CN9-2
+// 書き込みピン (部品ごと。使う部品の分だけ setup() で出力にする)
+namespace flash {
+  const byte PIN_BAR[] PROGMEM = { LED_RED_PIN, LED_GREEN_PIN, LED_BLUE_PIN, LED_BAR_1_PIN, LED_BAR_2_PIN, LED_BAR_3_PIN, LED_BAR_4_PIN, LED_BAR_5_PIN, LED_BAR_6_PIN, LED_BAR_7_PIN, LED_BAR_8_PIN, LED_BAR_9_PIN, LED_BAR_10_PIN };
+  const byte PIN_BUZZER[] PROGMEM = { BUZZER_PIN };
+  const byte PIN_BUS[] PROGMEM = { MODE_PIN, SEG_MODE_PIN, SEG_L1_PIN, SEG_L2_PIN, SEG_C1_PIN, SEG_C2_PIN, SEG_C3_PIN, SEG_R1_PIN, SEG_R2_PIN, SEG_POINT_PIN };
+  const byte PIN_MATRIX[] PROGMEM = { SER_PIN, SRCLK_PIN, RCLK_PIN };
+}
+constexpr auto PIN_BAR = flashTable(flash::PIN_BAR);
+constexpr auto PIN_BUZZER = flashTable(flash::PIN_BUZZER);
+constexpr auto PIN_BUS = flashTable(flash::PIN_BUS);
+constexpr auto PIN_MATRIX = flashTable(flash::PIN_MATRIX);
 
 // フォトインタラプタ
-const byte PHOTO_INTERRUPTER_PIN = 42; // CN3-6
+constexpr DigitalPin<42> PHOTO_INTERRUPTER_PIN {}; // CN3-6
 // 可変抵抗器
-const byte POTENTIOMETER_PIN = A15; // CN3-7
+constexpr DigitalPin<A15> POTENTIOMETER_PIN {}; // CN3-7
 // タクトスイッチ
-const byte TACT_TEST_LEFT_PIN = 44; // CN3-8
-const byte TACT_TEST_RIGHT_PIN = 45; // CN3-9
-const byte TACT_LEFT_LEFT_PIN = 49; // A-3 or A-2
-const byte TACT_LEFT_RIGHT_PIN = 51; // A-4 or A-3
-const byte TACT_RIGHT_LEFT_PIN = 50; // A-5 or A-4
-const byte TACT_RIGHT_RIGHT_PIN = 52; // A-6 or A-5
+constexpr DigitalPin<44> TACT_TEST_LEFT_PIN {}; // CN3-8
+constexpr DigitalPin<45> TACT_TEST_RIGHT_PIN {}; // CN3-9
+constexpr DigitalPin<49> TACT_LEFT_LEFT_PIN {}; // A-3 or A-2
+constexpr DigitalPin<51> TACT_LEFT_RIGHT_PIN {}; // A-4 or A-3
+constexpr DigitalPin<50> TACT_RIGHT_LEFT_PIN {}; // A-5 or A-4
+constexpr DigitalPin<52> TACT_RIGHT_RIGHT_PIN {}; // A-6 or A-5
 // トグルスイッチ
-const byte TOGGLE_PIN = 48; // A-2 or A-6
+constexpr DigitalPin<48> TOGGLE_PIN {}; // A-2 or A-6
 // ジョイスティック
-const byte JOYSTICK_X_PIN = A1; // A-7
-const byte JOYSTICK_Y_PIN = A2; // A-8
-// 読み込みピン
-const byte PIN_READ[] = { PHOTO_INTERRUPTER_PIN, TOGGLE_PIN, TACT_TEST_LEFT_PIN, TACT_TEST_RIGHT_PIN, TACT_LEFT_LEFT_PIN, TACT_LEFT_RIGHT_PIN, TACT_RIGHT_LEFT_PIN, TACT_RIGHT_RIGHT_PIN, POTENTIOMETER_PIN, JOYSTICK_X_PIN, JOYSTICK_Y_PIN };
+constexpr DigitalPin<A1> JOYSTICK_X_PIN {}; // A-7
+constexpr DigitalPin<A2> JOYSTICK_Y_PIN {}; // A-8
+// 読み込みピン (AD 変換のピンは ADC_PINS)
+namespace flash { const byte PIN_SWITCH[] PROGMEM = { PHOTO_INTERRUPTER_PIN, TOGGLE_PIN, TACT_TEST_LEFT_PIN, TACT_TEST_RIGHT_PIN, TACT_LEFT_LEFT_PIN, TACT_LEFT_RIGHT_PIN, TACT_RIGHT_LEFT_PIN, TACT_RIGHT_RIGHT_PIN }; }
+constexpr auto PIN_SWITCH = flashTable(flash::PIN_SWITCH);
+
+// 従来の全出力ピン・全読み込みピンの表 (非推奨、次の版で削除。部品ごとの PIN_BAR 等か pinsMode() を使う)
+namespace flash {
+  const byte PIN_WRITE[] PROGMEM = { LED_RED_PIN, LED_GREEN_PIN, LED_BLUE_PIN, LED_BAR_1_PIN, LED_BAR_2_PIN, LED_BAR_3_PIN, LED_BAR_4_PIN, LED_BAR_5_PIN, LED_BAR_6_PIN, LED_BAR_7_PIN, LED_BAR_8_PIN, LED_BAR_9_PIN, LED_BAR_10_PIN, BUZZER_PIN, MODE_PIN, SEG_MODE_PIN, SEG_L1_PIN, SEG_L2_PIN, SEG_C1_PIN, SEG_C2_PIN, SEG_C3_PIN, SEG_R1_PIN, SEG_R2_PIN, SEG_POINT_PIN, SER_PIN, SRCLK_PIN, RCLK_PIN };
+  const byte PIN_READ[] PROGMEM = { PHOTO_INTERRUPTER_PIN, TOGGLE_PIN, TACT_TEST_LEFT_PIN, TACT_TEST_RIGHT_PIN, TACT_LEFT_LEFT_PIN, TACT_LEFT_RIGHT_PIN, TACT_RIGHT_LEFT_PIN, TACT_RIGHT_RIGHT_PIN, POTENTIOMETER_PIN, JOYSTICK_X_PIN, JOYSTICK_Y_PIN };
+}
+constexpr auto PIN_WRITE __attribute__((deprecated("use PIN_BAR, PIN_BUZZER, PIN_BUS, PIN_MATRIX"))) = flashTable(flash::PIN_WRITE);
+constexpr auto PIN_READ __attribute__((deprecated("use PIN_SWITCH, ADC_PINS"))) = flashTable(flash::PIN_READ);
+
+// 表のピンをまとめて設定
+template<byte N> void pinsMode(const FlashTable<byte, N> &pins, const byte mode) {
+  for (byte i = 0; i < N; i++) pinMode(pins[i], mode);
+}
 
 /***********
  * 補助関数 *
@@ -182,16 +537,243 @@ inline void delaySecs(const float time) {
   delay((unsigned long) (time * 1000.0f));
 }
 
-// モーター処理切り替え
+// 7セグとモーターは同じ線 (PORTC) を時分割で使う
+typedef decltype(DC_MOTOR_1_PIN)::Port BusPort;
+const byte MOTOR_DC_BITS = DC_MOTOR_1_PIN.MASK | DC_MOTOR_2_PIN.MASK;
+const byte MOTOR_STEPPER_BITS = STEPPER_MOTOR_1_PIN.MASK | STEPPER_MOTOR_2_PIN.MASK | STEPPER_MOTOR_3_PIN.MASK | STEPPER_MOTOR_4_PIN.MASK;
+const byte MOTOR_BITS = MOTOR_DC_BITS | MOTOR_STEPPER_BITS;
+// システムタイマー (Timer4) の周波数
+const word TICK_HZ = 10000;
+// Timer4 の TOP (ICR4)。OC4B, OC4C はこの周期で LED バーの赤・緑の PWM にも使う
+const word TICK_TOP = F_CPU / TICK_HZ - 1;
+// 共有線の1周期のティック数 (1ms)
+const byte BUS_TICKS = 10;
+// 起動からのティック数 (100us 単位)
+static volatile unsigned long tick_count = 0;
+
+// ティック数を取得
+inline unsigned long ticks() {
+  const byte sreg = SREG;
+  cli();
+  const unsigned long count = tick_count;
+  SREG = sreg;
+  return count;
+}
+// ドライバーに保持させる値
+static volatile byte motor_bus = 0;
+// 7セグに出す値 (線の状態) と点灯中か
+static volatile byte seg_bus = 0;
+static volatile boolean seg_on = false;
+// 1周期のうちモーターに割り当てるティック数 (0 ならモーターの変化時のみラッチ)
+static volatile byte bus_motor_ticks = 0;
+// モーターの窓が開いているか
+static volatile boolean bus_motor = false;
+
+// motor_bus を線に出して MODE_PIN を1パルス (割り込み禁止中に呼ぶ)
+inline void motorLatch() {
+  const byte bus = BusPort::out();
+  BusPort::out() = (bus & ~MOTOR_BITS) | motor_bus;
+  // High の間に取り込み、Low で保持
+  MODE_PIN.high();
+  MODE_PIN.low();
+  // 7セグの値に戻す
+  BusPort::out() = bus;
+}
+
+// モーターの窓 (MODE_PIN を High のままにしてドライバーへ通す)
+inline void busMotor() {
+  SEG_MODE_PIN.low();
+  BusPort::out() = (BusPort::out() & ~MOTOR_BITS) | motor_bus;
+  MODE_PIN.high();
+  bus_motor = true;
+}
+
+// 7セグの窓 (ドライバーは MODE_PIN が Low の間は保持)
+inline void busSeg() {
+  MODE_PIN.low();
+  bus_motor = false;
+  if (seg_on) {
+    BusPort::out() = seg_bus;
+    SEG_MODE_PIN.high();
+  }
+}
+
+// 窓の切り替え (システムタイマーから毎ティック)
+inline void busTick() {
+  static byte phase = 0;
+  const byte motor_ticks = bus_motor_ticks;
+  // ラッチのみの場合は常に 7セグ
+  if (!motor_ticks) return;
+  // 片方しか使っていなければ切り替えない
+  if (!seg_on || motor_ticks >= BUS_TICKS) {
+    if (!bus_motor) busMotor();
+    return;
+  }
+  if (!motor_bus) {
+    if (bus_motor) busSeg();
+    return;
+  }
+  if (++phase >= BUS_TICKS) phase = 0;
+  if (phase == 0) busMotor();
+  else if (phase == motor_ticks) busSeg();
+}
+
+// モーターの割り当てを 0〜100% で設定
+// 0 (初期値) はラッチ式のドライバー向けで、モーターの変化時のみ MODE_PIN を動かす
+void busSplit(const byte motor_percent) {
+  const byte ticks = (min(motor_percent, 100) * BUS_TICKS + 50) / 100;
+  const byte sreg = SREG;
+  cli();
+  bus_motor_ticks = ticks;
+  if (!ticks && bus_motor) busSeg();
+  SREG = sreg;
+}
+
+// モーター側の一部の線を書き換えて適用 (割り込みからも呼ばれる)
+inline void motorWrite(const byte mask, const byte bits) {
+  const byte sreg = SREG;
+  cli();
+  const byte bus = (motor_bus & ~mask) | bits;
+  if (bus != motor_bus) {
+    motor_bus = bus;
+    // 窓が開いていればそのまま、7セグ側ならラッチだけ
+    if (bus_motor) {
+      BusPort::out() = (BusPort::out() & ~MOTOR_BITS) | bus;
+    } else {
+      motorLatch();
+    }
+  }
+  SREG = sreg;
+}
+
+// 7セグ側の値と点消灯を設定 (次の 7セグの窓から反映)
+inline void segWrite(const byte bus, const boolean on) {
+  const byte sreg = SREG;
+  cli();
+  // 変わらなければ線に触らない
+  if (bus == seg_bus && on == seg_on) {
+    SREG = sreg;
+    return;
+  }
+  seg_bus = bus;
+  seg_on = on;
+  if (!bus_motor) {
+    if (on) {
+      BusPort::out() = bus;
+      SEG_MODE_PIN.high();
+    } else {
+      SEG_MODE_PIN.low();
+    }
+  }
+  SREG = sreg;
+}
+
+// モーター処理切り替え (線上の値をそのまま使う)
 inline void mode(const boolean seg = false) {
-  // 書換準備 (セグは常時確定)
-  digitalWrite(MODE_PIN, LOW);
-  // 適用 (モーターのみ)
-  if (!seg) digitalWrite(MODE_PIN, HIGH);
-  // セグを点消灯
-  digitalWrite(SEG_MODE_PIN, seg);
+  if (seg) {
+    segWrite(BusPort::out(), true);
+  } else {
+    // 適用 (モーターのみ) してセグを消灯
+    motorWrite(MOTOR_BITS, BusPort::out() & MOTOR_BITS);
+    segWrite(seg_bus, false);
+  }
+}
+
+/********
+ * 計測 *
+ ********/
+
+// 計測点 (MONO_PROBES を定義してからインクルードした時だけ有効)
+enum Probe : byte { PROBE_LOOP, PROBE_STEPPER, PROBE_DC, PROBE_SEG, PROBE_MATRIX, PROBE_BAR, PROBE_SYNC_POT, PROBE_SYNC_ARROW, PROBE_SERVO, PROBE_BUZZ, PROBE_COUNT };
+
+// 起動からのクロック数 (ティック数と Timer4 のカウンタから 62.5ns 単位。32bit で一周する)
+inline unsigned long probeClock() {
+  const byte sreg = SREG;
+  cli();
+  unsigned long count = tick_count;
+  const word counter = TCNT4;
+  // TOP を過ぎてまだ割り込みが数えていない分
+  if ((TIFR4 & _BV(TOV4)) && counter < (TICK_TOP + 1) / 2) count++;
+  SREG = sreg;
+  return count * (TICK_TOP + 1) + counter;
+}
+
+#ifdef MONO_PROBES
+
+// 度数分布の区間数 (区間 k は 2^(k+4) クロック以上、最後は 2^19 (32ms) 以上)
+const byte PROBE_BUCKETS = 16;
+namespace flash { const char PROBE_NAMES[] PROGMEM = "loop\0stepper\0dc\0seg\0matrix\0bar\0syncPot\0syncArrow\0servo\0buzz\0"; }
+// 計測点ごとの集計 [クロック]
+struct ProbeStats {
+  unsigned long count;
+  unsigned long min;
+  unsigned long max;
+  unsigned long long sum;
+  word histogram[PROBE_BUCKETS];
+};
+static ProbeStats probe_stats[PROBE_COUNT];
+
+// 1回分を集計
+inline void probeRecord(const Probe id, const unsigned long cycles) {
+  ProbeStats &stats = probe_stats[id];
+  if (!stats.count || cycles < stats.min) stats.min = cycles;
+  if (cycles > stats.max) stats.max = cycles;
+  stats.count++;
+  stats.sum += cycles;
+  byte bucket = 0;
+  for (unsigned long rest = cycles >> 5; rest && bucket < PROBE_BUCKETS - 1; rest >>= 1) bucket++;
+  if (stats.histogram[bucket] < 0xFFFF) stats.histogram[bucket]++;
+}
+
+// 生存期間を計測する (割り込みの時間も含む)
+struct ProbeScope {
+  const Probe id;
+  const unsigned long start;
+  explicit ProbeScope(const Probe probe) : id(probe), start(probeClock()) {}
+  ~ProbeScope() {
+    probeRecord(id, probeClock() - start);
+  }
+};
+#define MONO_PROBE(id) ProbeScope mono_probe_scope(id)
+
+// 集計を消す
+void probeReset() {
+  memset(probe_stats, 0, sizeof(probe_stats));
+}
+
+// 集計を表で出力 (時間は us、度数は区間ごと)
+void probeDump(Stream &out = Serial) {
+  out.println(F("probe,count,min_us,mean_us,max_us,histogram"));
+  const char *name = flash::PROBE_NAMES;
+  for (byte i = 0; i < PROBE_COUNT; i++) {
+    // 割り込みで更新されないので、そのまま読む
+    const ProbeStats &stats = probe_stats[i];
+    out.print((const __FlashStringHelper *) name);
+    name += strlen_P(name) + 1;
+    out.print(',');
+    out.print(stats.count);
+    out.print(',');
+    out.print(stats.min / (F_CPU / 1000000.0f), 3);
+    out.print(',');
+    out.print(stats.count ? stats.sum / (float) stats.count / (F_CPU / 1000000.0f) : 0.0f, 3);
+    out.print(',');
+    out.print(stats.max / (F_CPU / 1000000.0f), 3);
+    for (byte k = 0; k < PROBE_BUCKETS; k++) {
+      out.print(k ? ' ' : ',');
+      out.print(stats.histogram[k]);
+    }
+    out.println();
+  }
 }
 
+#else
+
+// 無効時は何も生成しない
+#define MONO_PROBE(id) do {} while (0)
+inline void probeReset() {}
+
+#endif // MONO_PROBES
+
 /***************
  * 処理ここから *
  ***************/
@@ -201,23 +783,256 @@ inline void mode(const boolean seg = false) {
  **********************/
 
 // ピン配列
-const byte STEPPER_PINS[] = { STEPPER_MOTOR_1_PIN, STEPPER_MOTOR_2_PIN, STEPPER_MOTOR_3_PIN, STEPPER_MOTOR_4_PIN };
-// 1相励磁の駆動パターンを2次元配列で定義
-const byte STEPPER_PATTERNS[4][4] = { { HIGH, LOW, LOW, LOW }, { LOW, HIGH, LOW, LOW }, { LOW, LOW, HIGH, LOW }, { LOW, LOW, LOW, HIGH } };
+namespace flash { const byte STEPPER_PINS[] PROGMEM = { STEPPER_MOTOR_1_PIN, STEPPER_MOTOR_2_PIN, STEPPER_MOTOR_3_PIN, STEPPER_MOTOR_4_PIN }; }
+constexpr auto STEPPER_PINS = flashTable(flash::STEPPER_PINS);
+// 駆動パターンの1段 (STEPPER_PINS の順に HIGH / LOW)
+struct StepperPattern {
+  byte level[4];
+  inline byte operator[](const byte i) const { return level[i]; }
+};
+namespace flash {
+  // 1相励磁 (3°ずつ)
+  const StepperPattern STEPPER_PATTERNS[] PROGMEM = { { { HIGH, LOW, LOW, LOW } }, { { LOW, HIGH, LOW, LOW } }, { { LOW, LOW, HIGH, LOW } }, { { LOW, LOW, LOW, HIGH } } };
+  // 2相励磁 (3°ずつ、トルク重視)
+  const StepperPattern STEPPER_PATTERNS_TWO[] PROGMEM = { { { HIGH, HIGH, LOW, LOW } }, { { LOW, HIGH, HIGH, LOW } }, { { LOW, LOW, HIGH, HIGH } }, { { HIGH, LOW, LOW, HIGH } } };
+  // 1-2相励磁 (半ステップ、1.5°ずつ)
+  const StepperPattern STEPPER_PATTERNS_HALF[] PROGMEM = { { { HIGH, LOW, LOW, LOW } }, { { HIGH, HIGH, LOW, LOW } }, { { LOW, HIGH, LOW, LOW } }, { { LOW, HIGH, HIGH, LOW } }, { { LOW, LOW, HIGH, LOW } }, { { LOW, LOW, HIGH, HIGH } }, { { LOW, LOW, LOW, HIGH } }, { { HIGH, LOW, LOW, HIGH } } };
+}
+constexpr auto STEPPER_PATTERNS = flashTable(flash::STEPPER_PATTERNS);
+constexpr auto STEPPER_PATTERNS_TWO = flashTable(flash::STEPPER_PATTERNS_TWO);
+constexpr auto STEPPER_PATTERNS_HALF = flashTable(flash::STEPPER_PATTERNS_HALF);
 
-// ステッピングモーター制御関数
+// 励磁方式
+enum StepperMode : byte { PHASE_1, PHASE_2, PHASE_1_2 };
+// 従来の stepper() の速度 [steps/s]
+const word STEPPER_JOG_SPEED = 100;
+// タイマーの周波数 (Timer3、64分周で 4us)
+const unsigned long STEPPER_TIMER_HZ = F_CPU / 64;
+
+// 現在位置と目標位置 (励磁方式のステップ単位、時計回りが正)
+static volatile long stepper_position = 0;
+static volatile long stepper_target = 0;
+// 動作状態
+enum StepperState : byte { STEPPER_IDLE, STEPPER_MOVE, STEPPER_RUN, STEPPER_JOG };
+static volatile StepperState stepper_state = STEPPER_IDLE;
+static volatile StepperMode stepper_mode = PHASE_1;
+// 連続回転の向き
+static volatile char stepper_run_dir = 1;
+// 従来の stepper() が呼ばれたか
+static volatile boolean stepper_keepalive = false;
+// 加減速 (間隔はタイマーのカウント × 256)
+static volatile unsigned long stepper_c0 = 0;
+static volatile unsigned long stepper_cmin = 0;
+static volatile long stepper_ramp = 0;
+static unsigned long stepper_c = 0;
+static long stepper_n = 0;
+static char stepper_dir = 0;
+// 電気的な位相 (1-2相励磁の 0〜7)
+static byte stepper_phase = 0;
+
+// 駆動パターンの1段を線の値に
+inline byte stepperBits(const StepperPattern &pattern) {
+  return (pattern[0] ? STEPPER_MOTOR_1_PIN.MASK : 0) | (pattern[1] ? STEPPER_MOTOR_2_PIN.MASK : 0)
+       | (pattern[2] ? STEPPER_MOTOR_3_PIN.MASK : 0) | (pattern[3] ? STEPPER_MOTOR_4_PIN.MASK : 0);
+}
+
+// 1ステップ進めてドライバーへ適用 (1相・2相は全ステップの位相 0〜3 で表を引く)
+void stepperStep(const char dir) {
+  const boolean half = stepper_mode == PHASE_1_2;
+  stepper_phase = (stepper_phase + (half ? dir : 2 * dir)) & 7;
+  stepper_position += dir;
+  const StepperPattern pattern = half ? STEPPER_PATTERNS_HALF[stepper_phase]
+                               : stepper_mode == PHASE_2 ? STEPPER_PATTERNS_TWO[stepper_phase >> 1]
+                               : STEPPER_PATTERNS[stepper_phase >> 1];
+  motorWrite(MOTOR_STEPPER_BITS, stepperBits(pattern));
+}
+
+// 次のステップの向きと間隔を決める (D. Austin の台形加減速)
+boolean stepperPlan() {
+  const long to_stop = stepper_n > 0 ? stepper_n : -stepper_n;
+  // 連続回転は常に止まれる距離より先を目標にする
+  if (stepper_state == STEPPER_RUN) stepper_target = stepper_position + stepper_run_dir * (to_stop + 2);
+  const long distance = stepper_target - stepper_position;
+  if (distance == 0 && to_stop <= 1) return false;
+  // 止まりきれない、または逆向きなら減速に入る
+  if (distance > 0 ? (stepper_n > 0 && (to_stop >= distance || stepper_dir < 0)) : (stepper_n > 0 && (to_stop >= -distance || stepper_dir > 0))) {
+    stepper_n = -to_stop;
+  // 余裕があれば加速に戻す
+  } else if (distance > 0 ? (stepper_n < 0 && to_stop < distance && stepper_dir > 0) : (stepper_n < 0 && to_stop < -distance && stepper_dir < 0)) {
+    stepper_n = to_stop;
+  }
+  if (stepper_n == 0) {
+    // 停止からの1ステップ目
+    stepper_c = stepper_c0;
+    stepper_dir = distance > 0 ? 1 : -1;
+    stepper_n = 1;
+  } else {
+    stepper_c -= (long) (2 * stepper_c) / (4 * stepper_n + 1);
+    if (stepper_n > 0 && stepper_c <= stepper_cmin) {
+      // 最高速度で巡航 (n は減速に必要なステップ数のまま)
+      stepper_c = stepper_cmin;
+      stepper_n = stepper_ramp;
+    } else {
+      stepper_n++;
+    }
+  }
+  return true;
+}
+
+// タイマーを止めて待機 (連続回転と従来の stepper() は目標を動かさないので、止まった位置に合わせる)
+inline void stepperIdle() {
+  stepper_state = STEPPER_IDLE;
+  stepper_n = 0;
+  stepper_target = stepper_position;
+  TIMSK3 &= ~_BV(OCIE3B);
+}
+
+#if MONO_PROFILE & MONO_STEPPER
+// ステップ生成 (Timer3 の比較一致 B。A は Servo ライブラリが定義するので使わない)
+ISR(TIMER3_COMPB_vect) {
+  unsigned long interval;
+  if (stepper_state == STEPPER_JOG) {
+    // 呼ばれ続けている間だけ一定速度
+    if (!stepper_keepalive) {
+      stepperIdle();
+      return;
+    }
+    stepper_keepalive = false;
+    stepperStep(stepper_run_dir);
+    interval = STEPPER_TIMER_HZ / STEPPER_JOG_SPEED;
+  } else {
+    if (stepper_state == STEPPER_IDLE || !stepperPlan()) {
+      stepperIdle();
+      return;
+    }
+    stepperStep(stepper_dir);
+    interval = stepper_c >> 8;
+  }
+  // 比較値を進める (カウンタは止めないので割り込みの遅れが積もらない)
+  OCR3B += (word) min(interval, 0xFFFFUL);
+}
+#endif // MONO_STEPPER
+
+// タイマーを動かす (停止中なら直ちに1ステップ目)
+void stepperStart(const StepperState state) {
+  const byte sreg = SREG;
+  cli();
+  const boolean idle = stepper_state == STEPPER_IDLE;
+  stepper_state = state;
+  if (idle) {
+    stepper_n = 0;
+    OCR3B = TCNT3 + 2;
+    TIFR3 = _BV(OCF3B);
+    TIMSK3 |= _BV(OCIE3B);
+  }
+  SREG = sreg;
+}
+
+// 最高速度 [steps/s] と加速度 [steps/s^2] を設定
+void stepperSpeed(word speed, word accel) {
+  // タイマーの間隔が 16bit に収まる範囲 (4 steps/s 以上)
+  speed = max(speed, 4);
+  accel = max(accel, 14);
+  const unsigned long c0 = 0.676f * STEPPER_TIMER_HZ * sqrt(2.0f / accel) * 256.0f;
+  const long ramp = (long) speed * speed / (2L * accel);
+  const byte sreg = SREG;
+  cli();
+  stepper_c0 = c0;
+  stepper_cmin = STEPPER_TIMER_HZ * 256UL / speed;
+  stepper_ramp = ramp > 0 ? ramp : 1;
+  SREG = sreg;
+}
+
+// 励磁方式を変更 (位置は新しいステップ単位に換算)
+void stepperMode(const StepperMode mode) {
+  const byte sreg = SREG;
+  cli();
+  if (mode == PHASE_1_2 && stepper_mode != PHASE_1_2) {
+    stepper_position *= 2;
+    stepper_target *= 2;
+  } else if (mode != PHASE_1_2 && stepper_mode == PHASE_1_2) {
+    stepper_position /= 2;
+    stepper_target /= 2;
+  }
+  stepper_mode = mode;
+  SREG = sreg;
+}
+
+// 絶対位置へ移動
+void stepperMoveTo(const long position) {
+  const byte sreg = SREG;
+  cli();
+  stepper_target = position;
+  SREG = sreg;
+  stepperStart(STEPPER_MOVE);
+}
+
+// 現在の目標から相対移動
+void stepperMoveBy(const long steps) {
+  const byte sreg = SREG;
+  cli();
+  stepper_target += steps;
+  SREG = sreg;
+  stepperStart(STEPPER_MOVE);
+}
+
+// 連続回転 (正で時計回り、最高速度を変える場合は stepperSpeed)
+void stepperRun(const boolean reverse = false) {
+  stepper_run_dir = reverse ? -1 : 1;
+  stepperStart(STEPPER_RUN);
+}
+
+// 減速して停止
+void stepperStop() {
+  const byte sreg = SREG;
+  cli();
+  if (stepper_state != STEPPER_IDLE) {
+    stepper_target = stepper_position + stepper_dir * (stepper_n > 0 ? stepper_n : -stepper_n);
+    if (stepper_state != STEPPER_JOG) stepper_state = STEPPER_MOVE;
+  }
+  stepper_keepalive = false;
+  SREG = sreg;
+}
+
+// 現在位置
+long stepperPosition() {
+  const byte sreg = SREG;
+  cli();
+  const long position = stepper_position;
+  SREG = sreg;
+  return position;
+}
+
+// 現在位置を指定した値とみなす (停止中に使用)
+void stepperZero(const long position = 0) {
+  const byte sreg = SREG;
+  cli();
+  stepper_position = position;
+  stepper_target = position;
+  SREG = sreg;
+}
+
+// 動作中は true
+inline boolean isStepperMoving() {
+  return stepper_state != STEPPER_IDLE;
+}
+
+// 初期化 (標準動作、64分周)
+void stepperBegin() {
+  TCCR3A = 0;
+  TCCR3B = _BV(CS31) | _BV(CS30);
+  stepperSpeed(STEPPER_JOG_SPEED, 2 * STEPPER_JOG_SPEED);
+}
+
+// ステッピングモーター制御関数 (呼ばれ続けている間 100 steps/s で回る)
 void stepper(const boolean reverse = false) {
-  // 現在のステップ位置を0から3のインデックスで管理
-  static byte step_index = 0;
-  // 定義したパターンを4つのピンに一括で書き込む
-  for (byte i = 0; i < 4; i++)
-    digitalWrite(STEPPER_PINS[i], STEPPER_PATTERNS[reverse ? (3 - step_index) : step_index][i]);
-  // 次のステップのインデックスを計算
-  step_index = (step_index + 1) % 4;
-  // モーター処理切り替え
-  mode();
-  // 強制遅延
-  delay(10);
+  MONO_PROBE(PROBE_STEPPER);
+  const byte sreg = SREG;
+  cli();
+  stepper_run_dir = reverse ? -1 : 1;
+  stepper_keepalive = true;
+  SREG = sreg;
+  if (stepper_state != STEPPER_JOG) stepperStart(STEPPER_JOG);
 }
 
 /*************
@@ -227,13 +1042,60 @@ void stepper(const boolean reverse = false) {
 // DCモーターの動作モードを定義する列挙型
 enum DCMotor { LT, RT, S, F };
 
+// ソフトウェア PWM の1周期 [ティック] (250Hz)
+const byte DC_PWM_TICKS = 40;
+// PWM で回す向き (LT, RT 以外では PWM しない)
+static volatile DCMotor dc_pwm_action = S;
+// デューティ比 (0〜255)
+static volatile byte dc_duty = 0;
+// 速度制御の目標回転数 [rpm] (0 は制御しない)
+static volatile word dc_target = 0;
+
+// 動作モードに対応する線の値
+inline byte dcBits(const DCMotor action) {
+  return ((action == LT || action == S) ? DC_MOTOR_1_PIN.MASK : 0) | ((action == RT || action == S) ? DC_MOTOR_2_PIN.MASK : 0);
+}
+
+// PWM を1ティック進める (割り込みから呼ばれる)
+inline void dcPwmTick() {
+  static byte phase = 0;
+  static byte on_ticks = 0;
+  static word remainder = 0;
+  const DCMotor action = dc_pwm_action;
+  if (action != LT && action != RT) return;
+  if (phase == 0) {
+    // 端数は次の周期へ繰り越して平均のデューティ比を合わせる
+    remainder += (word) dc_duty * DC_PWM_TICKS;
+    on_ticks = remainder >> 8;
+    remainder &= 0xFF;
+    // 通電と減速 (F) を切り替える (変化が無ければ MODE_PIN も動かない)
+    motorWrite(MOTOR_DC_BITS, dcBits(on_ticks ? action : F));
+  } else if (phase == on_ticks) {
+    motorWrite(MOTOR_DC_BITS, dcBits(F));
+  }
+  if (++phase >= DC_PWM_TICKS) phase = 0;
+}
+
 // DC モーター制御
 void dc(const DCMotor action = S) {
+  MONO_PROBE(PROBE_DC);
+  // PWM・速度制御は止める
+  dc_target = 0;
+  dc_pwm_action = S;
   // ２ピンを４パターンで制御
-  digitalWrite(DC_MOTOR_1_PIN, (action == LT || action == S));
-  digitalWrite(DC_MOTOR_2_PIN, (action == RT || action == S));
-  // モーター処理切り替え
-  mode();
+  // (7セグとは共有線の窓で分け合うので、表示は消さない)
+  motorWrite(MOTOR_DC_BITS, dcBits(action));
+}
+
+// DC モーターを出力を絞って回す (duty は 0〜255)
+void dcPower(const DCMotor action, const byte duty) {
+  if (action != LT && action != RT) {
+    dc(action);
+    return;
+  }
+  dc_target = 0;
+  dc_duty = duty;
+  dc_pwm_action = action;
 }
 
 /**********
@@ -243,19 +1105,239 @@ void dc(const DCMotor action = S) {
 // ブザーの音の種類を定義する列挙型
 enum BuzzerTone { LO, MI, HI };
 // 型と値を同期
-const word BUZZ_FREQ[] = {
-  /* 低音 */ 400,
-  /* 中音 */ 800,
-  /* 高音 */ 1200
-};
-// ブザー鳴動制御
+namespace flash {
+  const word BUZZ_FREQ[] PROGMEM = {
+    /* 低音 */ 400,
+    /* 中音 */ 800,
+    /* 高音 */ 1200
+  };
+}
+constexpr auto BUZZ_FREQ = flashTable(flash::BUZZ_FREQ);
+// 音量の最大 (Timer2 の1周期のうち High の割合が 16/32 = 50%)
+const byte BUZZ_VOLUME = 16;
+// 待ち行列の長さ
+const byte BUZZ_QUEUE_SIZE = 4;
+
+// 優先度 (高い音は低い音を止めて割り込む。同じ優先度は順番待ち)
+enum BuzzPriority : byte { BUZZ_LOW, BUZZ_NORMAL, BUZZ_HIGH };
+// 音量の変化 (一定、減衰、立ち上がり)
+enum Envelope : byte { ENV_FLAT, ENV_DECAY, ENV_SWELL };
+
+// Timer2 の分周 (CS2 の値 1〜7 に対応)
+constexpr unsigned long buzzPrescale(const byte cs) {
+  return cs == 1 ? 1 : cs == 2 ? 8 : cs == 3 ? 32 : cs == 4 ? 64 : cs == 5 ? 128 : cs == 6 ? 256 : 1024;
+}
+// 周波数 [Hz] を Timer2 の設定 (上位が分周、下位が OCR2A。0 は休符) に
+constexpr word buzzTimer(const word hz, const byte cs = 1) {
+  return !hz ? 0
+       : cs == 7 || F_CPU / buzzPrescale(cs) / hz <= 256 ? (word) cs << 8 | (byte) (min(F_CPU / buzzPrescale(cs) / hz, 256UL) - 1)
+       : buzzTimer(hz, cs + 1);
+}
+
+// 1音 (Timer2 の設定はコンパイル時に計算しておく)
+struct Note { word timer; word ms; Envelope envelope; };
+constexpr Note note(const word hz, const word ms, const Envelope envelope = ENV_FLAT) {
+  return Note { buzzTimer(hz), ms, envelope };
+}
+constexpr Note rest(const word ms) {
+  return Note { 0, ms, ENV_FLAT };
+}
+// 効果音 (PROGMEM の Note 配列を repeat 回。アルペジオは短い音を並べて繰り返す)
+struct Sound { const Note *notes; byte count; BuzzPriority priority; byte repeat; };
+template<size_t N> constexpr Sound sound(const Note (&notes)[N], const BuzzPriority priority = BUZZ_NORMAL, const byte repeat = 1) {
+  return Sound { notes, N, priority, repeat };
+}
+
+// 効果音の定義
+namespace flash {
+  const Note SFX_CLICK[] PROGMEM = { note(2000, 15, ENV_DECAY) };
+  const Note SFX_OK[] PROGMEM = { note(1047, 60), note(1319, 60), note(1568, 120, ENV_DECAY) };
+  const Note SFX_NG[] PROGMEM = { note(400, 120), rest(40), note(300, 240, ENV_DECAY) };
+  const Note SFX_ARPEGGIO[] PROGMEM = { note(523, 30), note(659, 30), note(784, 30) };
+  const Note SFX_ALARM[] PROGMEM = { note(1200, 150), note(900, 150) };
+}
+namespace sfx {
+  const Sound CLICK PROGMEM = sound(flash::SFX_CLICK, BUZZ_HIGH);
+  const Sound OK PROGMEM = sound(flash::SFX_OK);
+  const Sound NG PROGMEM = sound(flash::SFX_NG);
+  const Sound ARPEGGIO PROGMEM = sound(flash::SFX_ARPEGGIO, BUZZ_NORMAL, 4);
+  const Sound ALARM PROGMEM = sound(flash::SFX_ALARM, BUZZ_HIGH, 5);
+}
+
+// 待ち行列の1件 (sound が NULL なら buzz() の単音)
+struct BuzzEntry { const Sound *sound; word timer; word ms; BuzzPriority priority; };
+// 優先度の高い順
+static BuzzEntry buzz_queue[BUZZ_QUEUE_SIZE];
+static volatile byte buzz_queued = 0;
+// 再生中 (buzz_playing が false なら無音)
+static BuzzEntry buzz_current;
+static volatile boolean buzz_playing = false;
+static Sound buzz_sound;
+static byte buzz_note = 0;
+static byte buzz_repeat = 0;
+// 今の音の残り [ms] と音量、音量を変える間隔 [ms]
+static word buzz_left = 0;
+static word buzz_timer = 0;
+static byte buzz_volume = 0;
+static Envelope buzz_envelope = ENV_FLAT;
+static word buzz_step = 0;
+static word buzz_step_left = 0;
+static byte buzz_tick = 0;
+
+// 音量に応じた OCR2B (周期の頭で反映)
+static volatile byte buzz_duty = 0;
+
+#if MONO_PROFILE & MONO_BUZZER
+// Timer2 の周期の頭で High、比較一致 B で Low (デューティ比が音量)
+ISR(TIMER2_COMPA_vect) {
+  BUZZER_PIN.high();
+  // 周期の途中で下げると Low にならない周期ができるので、ここで書き換える
+  OCR2B = buzz_duty;
+}
+ISR(TIMER2_COMPB_vect) {
+  BUZZER_PIN.low();
+}
+#endif // MONO_BUZZER
+
+// 音量だけ変える
+inline void buzzVolume(const byte volume) {
+  buzz_duty = ((word) (buzz_timer & 0xFF) + 1) * volume >> 5;
+}
+
+// Timer2 を timer の設定で鳴らす (0 で止める)
+inline void buzzOutput(const word timer, const byte volume) {
+  buzz_timer = timer;
+  if (!timer) {
+    TIMSK2 = 0;
+    BUZZER_PIN.low();
+    return;
+  }
+  // CTC (TOP = OCR2A)。途中から数えないように 0 から
+  TCCR2A = _BV(WGM21);
+  TCCR2B = timer >> 8;
+  OCR2A = timer & 0xFF;
+  buzzVolume(volume);
+  OCR2B = buzz_duty;
+  TCNT2 = 0;
+  TIFR2 = _BV(OCF2A) | _BV(OCF2B);
+  TIMSK2 = _BV(OCIE2A) | _BV(OCIE2B);
+}
+
+// 今の音を鳴らし始める
+inline void buzzNoteStart() {
+  Note note;
+  if (buzz_current.sound) {
+    note = flashRead(buzz_sound.notes + buzz_note);
+  } else {
+    note = Note { buzz_current.timer, buzz_current.ms, ENV_FLAT };
+  }
+  buzz_left = note.ms ? note.ms : 1;
+  buzz_envelope = note.envelope;
+  buzz_volume = note.envelope == ENV_SWELL ? 1 : BUZZ_VOLUME;
+  buzz_step = note.envelope == ENV_FLAT ? 0 : max(buzz_left / BUZZ_VOLUME, 1);
+  buzz_step_left = buzz_step;
+  buzzOutput(note.timer, buzz_volume);
+}
+
+// 待ち行列の先頭を取り出して鳴らす (無ければ止める)
+inline void buzzNext() {
+  if (!buzz_queued) {
+    buzz_playing = false;
+    buzzOutput(0, 0);
+    return;
+  }
+  buzz_current = buzz_queue[0];
+  buzz_queued--;
+  for (byte i = 0; i < buzz_queued; i++) buzz_queue[i] = buzz_queue[i + 1];
+  if (buzz_current.sound) buzz_sound = flashRead(buzz_current.sound);
+  buzz_note = 0;
+  buzz_repeat = buzz_current.sound && buzz_sound.repeat ? buzz_sound.repeat : 1;
+  buzz_playing = true;
+  buzzNoteStart();
+}
+
+// 1ms 毎に音を進める (システムタイマーから呼ばれる)
+inline void buzzTick() {
+  if (++buzz_tick < TICK_HZ / 1000) return;
+  buzz_tick = 0;
+  if (!buzz_playing) {
+    if (buzz_queued) buzzNext();
+    return;
+  }
+  // 音量の変化
+  if (buzz_step && !--buzz_step_left) {
+    buzz_step_left = buzz_step;
+    if (buzz_envelope == ENV_DECAY && buzz_volume > 1) buzzVolume(--buzz_volume);
+    else if (buzz_envelope == ENV_SWELL && buzz_volume < BUZZ_VOLUME) buzzVolume(++buzz_volume);
+  }
+  if (--buzz_left) return;
+  // 次の音、次の繰り返し、次の効果音
+  const byte count = buzz_current.sound ? buzz_sound.count : 1;
+  if (++buzz_note < count) {
+    buzzNoteStart();
+  } else if (--buzz_repeat) {
+    buzz_note = 0;
+    buzzNoteStart();
+  } else {
+    buzzNext();
+  }
+}
+
+// 同じ音が鳴っているか待っている時は true
+inline boolean buzzSame(const BuzzEntry &a, const BuzzEntry &b) {
+  return a.sound == b.sound && (a.sound || (a.timer == b.timer && a.ms == b.ms));
+}
+
+// 待ち行列に積む (同じ音の重複は無視し、優先度が上なら今の音を止めて鳴らす)
+void buzzEnqueue(const BuzzEntry &entry) {
+  const byte sreg = SREG;
+  cli();
+  boolean duplicate = buzz_playing && buzzSame(buzz_current, entry);
+  for (byte i = 0; i < buzz_queued; i++) if (buzzSame(buzz_queue[i], entry)) duplicate = true;
+  if (!duplicate) {
+    // 優先度の順で同じ優先度の後ろへ (一杯なら一番低いものを捨てる)
+    byte i = 0;
+    while (i < buzz_queued && buzz_queue[i].priority >= entry.priority) i++;
+    if (i < BUZZ_QUEUE_SIZE) {
+      for (byte j = min(buzz_queued, (byte) (BUZZ_QUEUE_SIZE - 1)); j > i; j--) buzz_queue[j] = buzz_queue[j - 1];
+      buzz_queue[i] = entry;
+      if (buzz_queued < BUZZ_QUEUE_SIZE) buzz_queued++;
+      // 割り込み (次の 1ms で先頭から鳴る)
+      if (buzz_playing && entry.priority > buzz_current.priority) buzz_playing = false;
+    }
+  }
+  SREG = sreg;
+}
+
+// PROGMEM の効果音を鳴らす (例：buzzPlay(sfx::OK))
+void buzzPlay(const Sound &sound) {
+  buzzEnqueue(BuzzEntry { &sound, 0, 0, flashRead(&sound).priority });
+}
+
+// 全て止めて待ち行列も空にする
+void buzzStop() {
+  const byte sreg = SREG;
+  cli();
+  buzz_queued = 0;
+  buzz_playing = false;
+  buzzOutput(0, 0);
+  SREG = sreg;
+}
+
+// 鳴っているか待っている音があれば true
+inline boolean isBuzzing() {
+  return buzz_playing || buzz_queued;
+}
+
+// ブザー鳴動制御 (割り込みで鳴らすので待たない。同じ音を鳴動中に呼んでも鳴らし直さない)
 void buzz(const word level = LO, const float duration = 0.0f) {
+  MONO_PROBE(PROBE_BUZZ);
   if (duration > 0.0f) {
     // 鳴動
-    tone(BUZZER_PIN, level > 2 ? level : BUZZ_FREQ[level], (unsigned long) (duration * 1000.0f));
+    buzzEnqueue(BuzzEntry { NULL, buzzTimer(level > 2 ? level : BUZZ_FREQ[level]), (word) (duration * 1000.0f), BUZZ_NORMAL });
   } else {
     // 消音
-    noTone(BUZZER_PIN);
+    buzzStop();
   }
 }
 
@@ -263,17 +1345,119 @@ void buzz(const word level = LO, const float duration = 0.0f) {
  * サーボモーター *
  *****************/
 
-// Servo のライブラリで制御
+#if MONO_PROFILE & MONO_SERVO
+// Servo のライブラリで制御 (Timer5 を使う)
 static Servo srv;
+#endif // MONO_SERVO
 // 可動域最小値
 const byte SERVO_MIN = 8;
 // 可動域最大値
 const byte SERVO_MAX = 160;
+// 軌道を更新する周期 [ティック] (Servo のパルスと同じ 50Hz)
+const byte SERVO_FRAME_HZ = 50;
+const word SERVO_FRAME_TICKS = TICK_HZ / SERVO_FRAME_HZ;
+// パルス幅の最小値・最大値・初期値 [us] (Servo.h の既定値と同じ)
+const word SERVO_MIN_PULSE_WIDTH = 544;
+const word SERVO_MAX_PULSE_WIDTH = 2400;
+const word SERVO_DEFAULT_PULSE_WIDTH = 1500;
+// 角度 1° あたりのパルス幅 [us] (attach() の既定の範囲を 180° に)
+const word SERVO_SPAN_US = SERVO_MAX_PULSE_WIDTH - SERVO_MIN_PULSE_WIDTH;
+
+// 位置・目標・速度 (パルス幅 [us] の 1/256 単位。速度と加速度は1フレームあたり)
+static long servo_position = (long) SERVO_DEFAULT_PULSE_WIDTH << 8;
+static volatile long servo_target = (long) SERVO_DEFAULT_PULSE_WIDTH << 8;
+static long servo_velocity = 0;
+// 最高速度と加速度 (0 なら即座に目標へ)
+static long servo_max_velocity = 0;
+static long servo_acceleration = 0;
+// 最後に書き込んだパルス幅 [us]
+static word servo_written = SERVO_DEFAULT_PULSE_WIDTH;
+static volatile boolean servo_reached = true;
+static byte servo_tick = 0;
+
+// 角度 [°] をパルス幅 [us] に
+inline word servoUs(const byte angle) {
+  return SERVO_MIN_PULSE_WIDTH + (unsigned long) angle * SERVO_SPAN_US / 180;
+}
+
+// 台形の速度で目標へ1フレーム進める (システムタイマーから呼ばれる)
+inline void servoTick() {
+  if (++servo_tick < SERVO_FRAME_TICKS) return;
+  servo_tick = 0;
+  const long target = servo_target;
+  const long distance = target - servo_position;
+  if (!distance && !servo_velocity) return;
+  if (!servo_max_velocity || !servo_acceleration) {
+    servo_position = target;
+    servo_velocity = 0;
+  } else {
+    // 目標の向きを正として、残りの距離と速度
+    const boolean forward = distance >= 0;
+    const unsigned long left = forward ? distance : -distance;
+    long speed = forward ? servo_velocity : -servo_velocity;
+    const long a = servo_acceleration;
+    if (speed < 0) {
+      // 逆向きに動いているので先に減速
+      speed += a;
+    } else if (left <= (unsigned long) speed * (speed / a + 1) / 2) {
+      // 止まるのに要る距離まで来たら減速 (止まり切る前に着くよう a は残す)
+      speed = max(speed - a, min(a, (long) left));
+    } else {
+      speed = min(speed + a, servo_max_velocity);
+    }
+    if (speed > 0 && (unsigned long) speed >= left) {
+      servo_position = target;
+      servo_velocity = 0;
+    } else {
+      servo_velocity = forward ? speed : -speed;
+      servo_position += servo_velocity;
+    }
+  }
+  servo_reached = servo_position == target && !servo_velocity;
+  // パルス幅が変わった時だけ書き込む
+  const word us = (servo_position + 128) >> 8;
+  if (us != servo_written) {
+    servo_written = us;
+#if MONO_PROFILE & MONO_SERVO
+    srv.writeMicroseconds(us);
+#endif // MONO_SERVO
+  }
+}
+
+// 最高速度 [°/s] と加速度 [°/s^2] (どちらか 0 で即座に動かす。最高速度は 1000°/s まで)
+void servoTune(const word max_speed, const word acceleration) {
+  const float scale = 256.0f * SERVO_SPAN_US / 180;
+  const long velocity = min(max_speed, 1000) * scale / SERVO_FRAME_HZ;
+  const long accel = max(acceleration * scale / ((long) SERVO_FRAME_HZ * SERVO_FRAME_HZ), acceleration ? 1.0f : 0.0f);
+  const byte sreg = SREG;
+  cli();
+  servo_max_velocity = velocity;
+  servo_acceleration = accel;
+  SREG = sreg;
+}
+
+// パルス幅 [us] を目標にする (同じ目標なら何もしない)
+void servoMicroseconds(const word us) {
+  const long target = (long) constrain(us, servoUs(SERVO_MIN), servoUs(SERVO_MAX)) << 8;
+  const byte sreg = SREG;
+  cli();
+  if (target != servo_target) {
+    servo_target = target;
+    servo_reached = false;
+  }
+  SREG = sreg;
+}
 
-// サーボモーター制御関数
+// サーボモーター制御関数 (割り込みが滑らかに目標の角度まで動かす)
 void servo(const byte angle = SERVO_MIN) {
+  MONO_PROBE(PROBE_SERVO);
   // 適用
-  srv.write(constrain(angle, SERVO_MIN, SERVO_MAX));
+  servoMicroseconds(servoUs(constrain(angle, SERVO_MIN, SERVO_MAX)));
+}
+
+// 目標に着いて止まっていれば true
+inline boolean isServoReached() {
+  return servo_reached;
 }
 
 /*********
@@ -281,12 +1465,15 @@ void servo(const byte angle = SERVO_MIN) {
  *********/
 
 // 7セグ の列挙型
-enum Segment { L1 = 0x01, L2 = 0x02, C1 = 0x04, C2 = 0x08, C3 = 0x10, R1 = 0x20, R2 = 0x40, POINT = 0x80 };
+enum Segment : byte { L1 = 0x01, L2 = 0x02, C1 = 0x04, C2 = 0x08, C3 = 0x10, R1 = 0x20, R2 = 0x40, POINT = 0x80 };
 struct SegPins { byte pin; Segment mask; };
-const SegPins seg_pins[] = { { SEG_L1_PIN, L1 }, { SEG_L2_PIN, L2 }, { SEG_C1_PIN, C1 }, { SEG_C2_PIN, C2 }, { SEG_C3_PIN, C3 }, { SEG_R1_PIN, R1 }, { SEG_R2_PIN, R2 }, { SEG_POINT_PIN, POINT } };
+namespace flash { const SegPins seg_pins[] PROGMEM = { { SEG_L1_PIN, L1 }, { SEG_L2_PIN, L2 }, { SEG_C1_PIN, C1 }, { SEG_C2_PIN, C2 }, { SEG_C3_PIN, C3 }, { SEG_R1_PIN, R1 }, { SEG_R2_PIN, R2 }, { SEG_POINT_PIN, POINT } }; }
+constexpr auto seg_pins = flashTable(flash::seg_pins);
+// 8セグ分のピン (Segment のビット順、PORTC の全ビット)
+typedef PinGroup<SEG_L1_PIN, SEG_L2_PIN, SEG_C1_PIN, SEG_C2_PIN, SEG_C3_PIN, SEG_R1_PIN, SEG_R2_PIN, SEG_POINT_PIN> SegPort;
 
 // int で直接描写できるように数字のみの配列を用意
-const Segment num[] = {
+namespace flash { const Segment num[] PROGMEM = {
   /* 0 */ (Segment) (L1 | L2 | C1 | C3 | R1 | R2),
   /* 1 */ (Segment) (R1 | R2),
   /* 2 */ (Segment) (L2 | C1 | C2 | C3 | R1),
@@ -303,7 +1490,8 @@ const Segment num[] = {
   /* d */ (Segment) (L2 | C2 | C3 | R1 | R2),
   /* E */ (Segment) (L1 | L2 | C1 | C2 | C3),
   /* F */ (Segment) (L1 | L2 | C1 | C2)
-};
+}; }
+constexpr auto num = flashTable(flash::num);
 
 // アルファベット
 namespace sg {
@@ -318,63 +1506,528 @@ namespace sg {
 
 // セグメント実行
 void seg(const byte mask = sg::ALL_0) {
-  for (byte i = 0; i < ARRAY_SIZE(seg_pins); i++)
-    digitalWrite(seg_pins[i].pin, (mask & seg_pins[i].mask));
-  // モーター処理切り替え
-  mode(true);
+  MONO_PROBE(PROBE_SEG);
+  // 全消灯ならモーターに線を譲る
+  segWrite(SegPort::bits<SEG_L1_PIN.PORT>(mask), mask != 0);
 }
 
 /*******************
  * LED マトリックス *
  *******************/
 
-namespace mt {
-  const byte ALL_0[8] = { B00000000, B00000000, B00000000, B00000000, B00000000, B00000000, B00000000, B00000000 };
-  const byte LEFT_1[8] = { B00000000, B00000000, B00000000, B00000000, B00000000, B00000000, B00000000, B11111111 };
-  const byte LEFT_2[8] = { B00000000, B00000000, B00000000, B00000000, B00000000, B00000000, B11111111, B00000000 };
-  const byte LEFT_3[8] = { B00000000, B00000000, B00000000, B00000000, B00000000, B11111111, B00000000, B00000000 };
-  const byte LEFT_4[8] = { B00000000, B00000000, B00000000, B00000000, B11111111, B00000000, B00000000, B00000000 };
-  const byte LEFT_5[8] = { B00000000, B00000000, B00000000, B11111111, B00000000, B00000000, B00000000, B00000000 };
-  const byte LEFT_6[8] = { B00000000, B00000000, B11111111, B00000000, B00000000, B00000000, B00000000, B00000000 };
-  const byte LEFT_7[8] = { B00000000, B11111111, B00000000, B00000000, B00000000, B00000000, B00000000, B00000000 };
-  const byte LEFT_8[8] = { B11111111, B00000000, B00000000, B00000000, B00000000, B00000000, B00000000, B00000000 };
-  const byte UP_1[8] = { B00000001, B00000001, B00000001, B00000001, B00000001, B00000001, B00000001, B00000001 };
-  const byte UP_2[8] = { B00000010, B00000010, B00000010, B00000010, B00000010, B00000010, B00000010, B00000010 };
-  const byte UP_3[8] = { B00000100, B00000100, B00000100, B00000100, B00000100, B00000100, B00000100, B00000100 };
-  const byte UP_4[8] = { B00001000, B00001000, B00001000, B00001000, B00001000, B00001000, B00001000, B00001000 };
-  const byte UP_5[8] = { B00010000, B00010000, B00010000, B00010000, B00010000, B00010000, B00010000, B00010000 };
-  const byte UP_6[8] = { B00100000, B00100000, B00100000, B00100000, B00100000, B00100000, B00100000, B00100000 };
-  const byte UP_7[8] = { B01000000, B01000000, B01000000, B01000000, B01000000, B01000000, B01000000, B01000000 };
-  const byte UP_8[8] = { B10000000, B10000000, B10000000, B10000000, B10000000, B10000000, B10000000, B10000000 };
-  const byte LEFT[8] = { B00011000, B00011000, B00011000, B00011000, B11111111, B01111110, B00111100, B00011000 };
-  const byte RIGHT[8] = { B00011000, B00111100, B01111110, B11111111, B00011000, B00011000, B00011000, B00011000 };
-  const byte UP[8] = { B00001000, B00001100, B00001110, B11111111, B11111111, B00001110, B00001100, B00001000 };
-  const byte DOWN[8] = { B00010000, B00110000, B01110000, B11111111, B11111111, B01110000, B00110000, B00010000 };
-}
+// 8×8 の図柄 (PROGMEM に置いて matrix() に渡す)
+// column[0] が右端の列で、各列の bit0 が上端の行
+// [] は従来の byte[8] の mt:: と同じく列を返す (フラッシュから読む)
+struct Glyph {
+  byte column[8];
+  byte operator[](const byte i) const { return pgm_read_byte(&column[i]); }
+};
 
-// 消灯用
-void matrix_reset() {
-  digitalWrite(RCLK_PIN, LOW);
-  shiftOut(SER_PIN, SRCLK_PIN, MSBFIRST, B00000000); // 行
-  shiftOut(SER_PIN, SRCLK_PIN, MSBFIRST, B00000000); // 列
-  digitalWrite(RCLK_PIN, HIGH);
+// 図柄を上の行から8行の文字列で書く ('.' と ' ' 以外が点灯、各行は左から8文字)
+constexpr byte glyphDot(const char *row, const byte x) {
+  return row[x] != '.' && row[x] != ' ' ? 1 : 0;
 }
-
-// 点灯
-void matrix(const byte pattern[8] = mt::ALL_0) {
-  // 1フレーム（8列分）を描画
-  for (byte column = 0; column < 8; column++) {
-    // 残像防止のため、一旦非表示
-    matrix_reset();
-    // ラッチピンを下げて、データ送信を開始
-    digitalWrite(RCLK_PIN, LOW);
-    // 行・Row（下から上へ）
-    shiftOut(SER_PIN, SRCLK_PIN, MSBFIRST, pattern[column]);
-    // 列・Column（右から左へ）
-    shiftOut(SER_PIN, SRCLK_PIN, MSBFIRST, 1 << column);
-    // ラッチピンを上げて、シフトレジスタのデータに反映させる
-    digitalWrite(RCLK_PIN, HIGH);
+// 左から x 列目の値
+constexpr byte glyphColumn(const byte x, const char *r0, const char *r1, const char *r2, const char *r3, const char *r4, const char *r5, const char *r6, const char *r7) {
+  return glyphDot(r0, x) | glyphDot(r1, x) << 1 | glyphDot(r2, x) << 2 | glyphDot(r3, x) << 3 | glyphDot(r4, x) << 4 | glyphDot(r5, x) << 5 | glyphDot(r6, x) << 6 | glyphDot(r7, x) << 7;
+}
+#define MONO_GLYPH_COLUMN(x) glyphColumn(x, r0, r1, r2, r3, r4, r5, r6, r7)
+constexpr Glyph glyph(const char *r0, const char *r1, const char *r2, const char *r3, const char *r4, const char *r5, const char *r6, const char *r7) {
+  return { { MONO_GLYPH_COLUMN(7), MONO_GLYPH_COLUMN(6), MONO_GLYPH_COLUMN(5), MONO_GLYPH_COLUMN(4), MONO_GLYPH_COLUMN(3), MONO_GLYPH_COLUMN(2), MONO_GLYPH_COLUMN(1), MONO_GLYPH_COLUMN(0) } };
+}
+#undef MONO_GLYPH_COLUMN
+// 左から x 列目だけ (縦線)
+constexpr Glyph glyphVertical(const byte x) {
+  return { { (byte) (x == 7 ? 0xFF : 0), (byte) (x == 6 ? 0xFF : 0), (byte) (x == 5 ? 0xFF : 0), (byte) (x == 4 ? 0xFF : 0), (byte) (x == 3 ? 0xFF : 0), (byte) (x == 2 ? 0xFF : 0), (byte) (x == 1 ? 0xFF : 0), (byte) (x == 0 ? 0xFF : 0) } };
+}
+// 上から y 行目だけ (横線)
+constexpr Glyph glyphHorizontal(const byte y) {
+  return { { (byte) (1 << y), (byte) (1 << y), (byte) (1 << y), (byte) (1 << y), (byte) (1 << y), (byte) (1 << y), (byte) (1 << y), (byte) (1 << y) } };
+}
+
+namespace mt {
+  const Glyph ALL_0 PROGMEM = {};
+  const Glyph LEFT_1 PROGMEM = glyphVertical(0);
+  const Glyph LEFT_2 PROGMEM = glyphVertical(1);
+  const Glyph LEFT_3 PROGMEM = glyphVertical(2);
+  const Glyph LEFT_4 PROGMEM = glyphVertical(3);
+  const Glyph LEFT_5 PROGMEM = glyphVertical(4);
+  const Glyph LEFT_6 PROGMEM = glyphVertical(5);
+  const Glyph LEFT_7 PROGMEM = glyphVertical(6);
+  const Glyph LEFT_8 PROGMEM = glyphVertical(7);
+  const Glyph UP_1 PROGMEM = glyphHorizontal(0);
+  const Glyph UP_2 PROGMEM = glyphHorizontal(1);
+  const Glyph UP_3 PROGMEM = glyphHorizontal(2);
+  const Glyph UP_4 PROGMEM = glyphHorizontal(3);
+  const Glyph UP_5 PROGMEM = glyphHorizontal(4);
+  const Glyph UP_6 PROGMEM = glyphHorizontal(5);
+  const Glyph UP_7 PROGMEM = glyphHorizontal(6);
+  const Glyph UP_8 PROGMEM = glyphHorizontal(7);
+  const Glyph LEFT PROGMEM = glyph(
+    "...#....",
+    "..##....",
+    ".###....",
+    "########",
+    "########",
+    ".###....",
+    "..##....",
+    "...#....");
+  const Glyph RIGHT PROGMEM = glyph(
+    "....#...",
+    "....##..",
+    "....###.",
+    "########",
+    "########",
+    "....###.",
+    "....##..",
+    "....#...");
+  const Glyph UP PROGMEM = glyph(
+    "...##...",
+    "..####..",
+    ".######.",
+    "########",
+    "...##...",
+    "...##...",
+    "...##...",
+    "...##...");
+  const Glyph DOWN PROGMEM = glyph(
+    "...##...",
+    "...##...",
+    "...##...",
+    "...##...",
+    "########",
+    ".######.",
+    "..####..",
+    "...##...");
+}
+
+// 5×7 の文字 (column[0] が左端の列で、各列の bit0 が上端の行)
+struct FontGlyph { byte column[5]; };
+const byte FONT_WIDTH = 5;
+
+// 文字を上の行から7行の文字列で書く (各行は左から5文字)
+constexpr FontGlyph fontGlyph(const char *r0, const char *r1, const char *r2, const char *r3, const char *r4, const char *r5, const char *r6) {
+  return { {
+    glyphColumn(0, r0, r1, r2, r3, r4, r5, r6, "....."), glyphColumn(1, r0, r1, r2, r3, r4, r5, r6, "....."), glyphColumn(2, r0, r1, r2, r3, r4, r5, r6, "....."),
+    glyphColumn(3, r0, r1, r2, r3, r4, r5, r6, "....."), glyphColumn(4, r0, r1, r2, r3, r4, r5, r6, ".....")
+  } };
+}
+
+// ASCII の ' ' 〜 '~'
+const FontGlyph FONT[] PROGMEM = {
+  /* ' ' */ fontGlyph(".....", ".....", ".....", ".....", ".....", ".....", "....."),
+  /* '!' */ fontGlyph("..#..", "..#..", "..#..", "..#..", "..#..", ".....", "..#.."),
+  /* '"' */ fontGlyph(".#.#.", ".#.#.", ".#.#.", ".....", ".....", ".....", "....."),
+  /* '#' */ fontGlyph(".#.#.", ".#.#.", "#####", ".#.#.", "#####", ".#.#.", ".#.#."),
+  /* '$' */ fontGlyph("..#..", ".####", "#.#..", ".###.", "..#.#", "####.", "..#.."),
+  /* '%' */ fontGlyph("##...", "##..#", "...#.", "..#..", ".#...", "#..##", "...##"),
+  /* '&' */ fontGlyph(".##..", "#..#.", "#.#..", ".#...", "#.#.#", "#..#.", ".##.#"),
+  /* '\'' */ fontGlyph(".##..", "..#..", ".#...", ".....", ".....", ".....", "....."),
+  /* '(' */ fontGlyph("...#.", "..#..", ".#...", ".#...", ".#...", "..#..", "...#."),
+  /* ')' */ fontGlyph(".#...", "..#..", "...#.", "...#.", "...#.", "..#..", ".#..."),
+  /* '*' */ fontGlyph(".....", ".#.#.", "..#..", "#####", "..#..", ".#.#.", "....."),
+  /* '+' */ fontGlyph(".....", "..#..", "..#..", "#####", "..#..", "..#..", "....."),
+  /* ',' */ fontGlyph(".....", ".....", ".....", ".....", ".##..", "..#..", ".#..."),
+  /* '-' */ fontGlyph(".....", ".....", ".....", "#####", ".....", ".....", "....."),
+  /* '.' */ fontGlyph(".....", ".....", ".....", ".....", ".....", ".##..", ".##.."),
+  /* '/' */ fontGlyph(".....", "....#", "...#.", "..#..", ".#...", "#....", "....."),
+  /* '0' */ fontGlyph(".###.", "#...#", "#..##", "#.#.#", "##..#", "#...#", ".###."),
+  /* '1' */ fontGlyph("..#..", ".##..", "..#..", "..#..", "..#..", "..#..", ".###."),
+  /* '2' */ fontGlyph(".###.", "#...#", "....#", "...#.", "..#..", ".#...", "#####"),
+  /* '3' */ fontGlyph("#####", "...#.", "..#..", "...#.", "....#", "#...#", ".###."),
+  /* '4' */ fontGlyph("...#.", "..##.", ".#.#.", "#..#.", "#####", "...#.", "...#."),
+  /* '5' */ fontGlyph("#####", "#....", "####.", "....#", "....#", "#...#", ".###."),
+  /* '6' */ fontGlyph("..##.", ".#...", "#....", "####.", "#...#", "#...#", ".###."),
+  /* '7' */ fontGlyph("#####", "....#", "...#.", "..#..", ".#...", ".#...", ".#..."),
+  /* '8' */ fontGlyph(".###.", "#...#", "#...#", ".###.", "#...#", "#...#", ".###."),
+  /* '9' */ fontGlyph(".###.", "#...#", "#...#", ".####", "....#", "...#.", ".##.."),
+  /* ':' */ fontGlyph(".....", ".##..", ".##..", ".....", ".##..", ".##..", "....."),
+  /* ';' */ fontGlyph(".....", ".##..", ".##..", ".....", ".##..", "..#..", ".#..."),
+  /* '<' */ fontGlyph("...#.", "..#..", ".#...", "#....", ".#...", "..#..", "...#."),
+  /* '=' */ fontGlyph(".....", ".....", "#####", ".....", "#####", ".....", "....."),
+  /* '>' */ fontGlyph(".#...", "..#..", "...#.", "....#", "...#.", "..#..", ".#..."),
+  /* '?' */ fontGlyph(".###.", "#...#", "....#", "...#.", "..#..", ".....", "..#.."),
+  /* '@' */ fontGlyph(".###.", "#...#", "....#", ".##.#", "#.#.#", "#.#.#", ".###."),
+  /* 'A' */ fontGlyph(".###.", "#...#", "#...#", "#...#", "#####", "#...#", "#...#"),
+  /* 'B' */ fontGlyph("####.", "#...#", "#...#", "####.", "#...#", "#...#", "####."),
+  /* 'C' */ fontGlyph(".###.", "#...#", "#....", "#....", "#....", "#...#", ".###."),
+  /* 'D' */ fontGlyph("###..", "#..#.", "#...#", "#...#", "#...#", "#..#.", "###.."),
+  /* 'E' */ fontGlyph("#####", "#....", "#....", "####.", "#....", "#....", "#####"),
+  /* 'F' */ fontGlyph("#####", "#....", "#....", "###..", "#....", "#....", "#...."),
+  /* 'G' */ fontGlyph(".###.", "#...#", "#....", "#....", "#..##", "#...#", ".###."),
+  /* 'H' */ fontGlyph("#...#", "#...#", "#...#", "#####", "#...#", "#...#", "#...#"),
+  /* 'I' */ fontGlyph(".###.", "..#..", "..#..", "..#..", "..#..", "..#..", ".###."),
+  /* 'J' */ fontGlyph("..###", "...#.", "...#.", "...#.", "...#.", "#..#.", ".##.."),
+  /* 'K' */ fontGlyph("#...#", "#..#.", "#.#..", "##...", "#.#..", "#..#.", "#...#"),
+  /* 'L' */ fontGlyph("#....", "#....", "#....", "#....", "#....", "#....", "#####"),
+  /* 'M' */ fontGlyph("#...#", "##.##", "#.#.#", "#...#", "#...#", "#...#", "#...#"),
+  /* 'N' */ fontGlyph("#...#", "#...#", "##..#", "#.#.#", "#..##", "#...#", "#...#"),
+  /* 'O' */ fontGlyph(".###.", "#...#", "#...#", "#...#", "#...#", "#...#", ".###."),
+  /* 'P' */ fontGlyph("####.", "#...#", "#...#", "####.", "#....", "#....", "#...."),
+  /* 'Q' */ fontGlyph(".###.", "#...#", "#...#", "#...#", "#.#.#", "#..#.", ".##.#"),
+  /* 'R' */ fontGlyph("####.", "#...#", "#...#", "####.", "#.#..", "#..#.", "#...#"),
+  /* 'S' */ fontGlyph(".####", "#....", "#....", ".###.", "....#", "....#", "####."),
+  /* 'T' */ fontGlyph("#####", "..#..", "..#..", "..#..", "..#..", "..#..", "..#.."),
+  /* 'U' */ fontGlyph("#...#", "#...#", "#...#", "#...#", "#...#", "#...#", ".###."),
+  /* 'V' */ fontGlyph("#...#", "#...#", "#...#", "#...#", "#...#", ".#.#.", "..#.."),
+  /* 'W' */ fontGlyph("#...#", "#...#", "#...#", "#.#.#", "#.#.#", "##.##", "#...#"),
+  /* 'X' */ fontGlyph("#...#", "#...#", ".#.#.", "..#..", ".#.#.", "#...#", "#...#"),
+  /* 'Y' */ fontGlyph("#...#", "#...#", ".#.#.", "..#..", "..#..", "..#..", "..#.."),
+  /* 'Z' */ fontGlyph("#####", "....#", "...#.", "..#..", ".#...", "#....", "#####"),
+  /* '[' */ fontGlyph(".###.", ".#...", ".#...", ".#...", ".#...", ".#...", ".###."),
+  /* '\\' */ fontGlyph(".....", "#....", ".#...", "..#..", "...#.", "....#", "....."),
+  /* ']' */ fontGlyph(".###.", "...#.", "...#.", "...#.", "...#.", "...#.", ".###."),
+  /* '^' */ fontGlyph("..#..", ".#.#.", "#...#", ".....", ".....", ".....", "....."),
+  /* '_' */ fontGlyph(".....", ".....", ".....", ".....", ".....", ".....", "#####"),
+  /* '`' */ fontGlyph(".#...", "..#..", "...#.", ".....", ".....", ".....", "....."),
+  /* 'a' */ fontGlyph(".....", ".....", ".###.", "....#", ".####", "#...#", ".####"),
+  /* 'b' */ fontGlyph("#....", "#....", "#.##.", "##..#", "#...#", "#...#", "####."),
+  /* 'c' */ fontGlyph(".....", ".....", ".###.", "#....", "#....", "#...#", ".###."),
+  /* 'd' */ fontGlyph("....#", "....#", ".##.#", "#..##", "#...#", "#...#", ".####"),
+  /* 'e' */ fontGlyph(".....", ".....", ".###.", "#...#", "#####", "#....", ".###."),
+  /* 'f' */ fontGlyph("..##.", ".#..#", ".#...", "###..", ".#...", ".#...", ".#..."),
+  /* 'g' */ fontGlyph(".....", ".....", ".####", "#...#", ".####", "....#", ".###."),
+  /* 'h' */ fontGlyph("#....", "#....", "#.##.", "##..#", "#...#", "#...#", "#...#"),
+  /* 'i' */ fontGlyph("..#..", ".....", ".##..", "..#..", "..#..", "..#..", ".###."),
+  /* 'j' */ fontGlyph("...#.", ".....", "..##.", "...#.", "...#.", "#..#.", ".##.."),
+  /* 'k' */ fontGlyph("#....", "#....", "#..#.", "#.#..", "##...", "#.#..", "#..#."),
+  /* 'l' */ fontGlyph(".##..", "..#..", "..#..", "..#..", "..#..", "..#..", ".###."),
+  /* 'm' */ fontGlyph(".....", ".....", "##.#.", "#.#.#", "#.#.#", "#...#", "#...#"),
+  /* 'n' */ fontGlyph(".....", ".....", "#.##.", "##..#", "#...#", "#...#", "#...#"),
+  /* 'o' */ fontGlyph(".....", ".....", ".###.", "#...#", "#...#", "#...#", ".###."),
+  /* 'p' */ fontGlyph(".....", ".....", "####.", "#...#", "####.", "#....", "#...."),
+  /* 'q' */ fontGlyph(".....", ".....", ".##.#", "#..##", ".####", "....#", "....#"),
+  /* 'r' */ fontGlyph(".....", ".....", "#.##.", "##..#", "#....", "#....", "#...."),
+  /* 's' */ fontGlyph(".....", ".....", ".###.", "#....", ".###.", "....#", "####."),
+  /* 't' */ fontGlyph(".#...", ".#...", "###..", ".#...", ".#...", ".#..#", "..##."),
+  /* 'u' */ fontGlyph(".....", ".....", "#...#", "#...#", "#...#", "#..##", ".##.#"),
+  /* 'v' */ fontGlyph(".....", ".....", "#...#", "#...#", "#...#", ".#.#.", "..#.."),
+  /* 'w' */ fontGlyph(".....", ".....", "#...#", "#...#", "#.#.#", "#.#.#", ".#.#."),
+  /* 'x' */ fontGlyph(".....", ".....", "#...#", ".#.#.", "..#..", ".#.#.", "#...#"),
+  /* 'y' */ fontGlyph(".....", ".....", "#...#", "#...#", ".####", "....#", ".###."),
+  /* 'z' */ fontGlyph(".....", ".....", "#####", "...#.", "..#..", ".#...", "#####"),
+  /* '{' */ fontGlyph("...#.", "..#..", "..#..", ".#...", "..#..", "..#..", "...#."),
+  /* '|' */ fontGlyph("..#..", "..#..", "..#..", "..#..", "..#..", "..#..", "..#.."),
+  /* '}' */ fontGlyph(".#...", "..#..", "..#..", "...#.", "..#..", "..#..", ".#..."),
+  /* '~' */ fontGlyph(".....", ".....", ".#...", "#.#.#", "...#.", ".....", ".....")
+};
+
+// 文字 c の左から x 列目 (範囲外の文字は '?'、x が幅以上なら空白)
+inline byte fontColumn(const char c, const byte x) {
+  if (x >= FONT_WIDTH) return 0;
+  return pgm_read_byte(&FONT[(c < ' ' || c > '~' ? '?' : c) - ' '].column[x]);
+}
+
+// 1列の更新周波数 (8列で 250Hz)
+const word MATRIX_COLUMN_HZ = 2000;
+// 階調のビット数 (0〜15 の16段階)
+const byte MATRIX_DEPTH = 4;
+const byte MATRIX_LEVEL_MAX = (1 << MATRIX_DEPTH) - 1;
+// 最下位ビット面の長さ [Timer1 のカウント、8分周で 0.5us]
+// 1列をビット面ごとに 1:2:4:8 の長さで点灯 (BCM、合計 495us)
+const word MATRIX_SLOT_COUNT = F_CPU / 8 / MATRIX_COLUMN_HZ / MATRIX_LEVEL_MAX;
+// これより短い点灯は割り込みが間に合わないので、そのビット面を消す
+const word MATRIX_ON_MIN = 16;
+// 比較値を設定し終えるまでのカウント数 (これより遅れた割り込みは比較値を今から数え直す)
+const byte MATRIX_LATE_MARGIN = 4;
+
+// 表示用と書き込み用の2面をビット面ごとに (割り込みが列 0 の時に入れ替える)
+static volatile byte matrix_buffer[2][MATRIX_DEPTH][8];
+// 表示中の面
+static volatile byte matrix_front = 0;
+// 入れ替え待ち
+static volatile boolean matrix_swap = false;
+// 全体の明るさ (255 で最大) と、それを掛けたビット面ごとの点灯時間 [カウント]
+static byte matrix_brightness = 255;
+static volatile word matrix_on[MATRIX_DEPTH] = {
+  MATRIX_SLOT_COUNT, MATRIX_SLOT_COUNT << 1, MATRIX_SLOT_COUNT << 2, MATRIX_SLOT_COUNT << 3
+};
+// 階調の書き込み用 [y][x] (左上が 0, 0)
+static byte matrix_gray[8][8];
+
+// フラッシュからの再生 (静止画、コマ送り、文字の横スクロール)
+enum MatrixPlay : byte { MATRIX_STILL, MATRIX_FRAMES, MATRIX_TEXT };
+static volatile MatrixPlay matrix_play = MATRIX_STILL;
+// 再生元 (PROGMEM の Glyph 配列か文字列)
+static const void *matrix_play_data = NULL;
+// コマ数、またはスクロールする列数
+static word matrix_play_length = 0;
+static word matrix_play_index = 0;
+// 1コマの長さと残り [フレーム]
+static word matrix_play_period = 1;
+static word matrix_play_wait = 0;
+static boolean matrix_play_repeat = false;
+
+// 上位から N ビットを送信 (ループを展開し、1ビット数サイクル)
+template<byte N> inline __attribute__((always_inline)) void matrixShift(const word data) {
+  if (data & (word) (1U << (N - 1))) SER_PIN.high(); else SER_PIN.low();
+  // シフトクロックを1パルス
+  SRCLK_PIN.toggle();
+  SRCLK_PIN.toggle();
+  matrixShift<N - 1>(data);
+}
+template<> inline void matrixShift<0>(const word) {}
+
+// ラッチクロックを1パルス (RCLK は待機中 Low)
+inline void matrixLatch() {
+  RCLK_PIN.toggle();
+  RCLK_PIN.toggle();
+}
+
+// 行・列の 16bit を送信してラッチ
+inline void matrixWrite(const word data) {
+  // 行 (上位)、列 (下位) の順に MSB から
+  matrixShift<16>(data);
+  matrixLatch();
+}
+
+// 消灯 (列を 0 にするだけなので 8bit 送信して1回ラッチ)
+inline void matrixBlank() {
+  matrixShift<8>(0);
+  matrixLatch();
+}
+
+// 文字列を横に並べた帯の s 列目から8列分を描く (先頭に空白8列、各文字の後に空白1列)
+inline void matrixTextFrame(byte *back, const char *text, const word length, const word s) {
+  word index = 0;
+  byte x = 0;
+  if (s >= 8) {
+    index = (s - 8) / (FONT_WIDTH + 1);
+    x = (s - 8) % (FONT_WIDTH + 1);
+  }
+  for (byte column = 0; column < 8; column++) {
+    // 右端 (column[0]) から見て左端の列が s
+    const word position = s + column;
+    byte bits = 0;
+    if (position >= 8 && index < length) {
+      bits = fontColumn(pgm_read_byte(text + index), x);
+      if (++x > FONT_WIDTH) {
+        x = 0;
+        index++;
+      }
+    }
+    back[7 - column] = bits;
+  }
+}
+
+// 書き込み用の面の最上位ビット面を下位へ写す (2値の図柄を最大の階調で表示)
+inline void matrixSpread() {
+  byte (*back)[8] = (byte (*)[8]) matrix_buffer[matrix_front ^ 1];
+  for (byte bit = 0; bit < MATRIX_DEPTH - 1; bit++) memcpy(back[bit], back[MATRIX_DEPTH - 1], 8);
+}
+
+// 次のコマを書き込み用の面に描いて入れ替えを予約 (割り込みから呼ばれる)
+inline void matrixPlayStep() {
+  byte *back = (byte *) matrix_buffer[matrix_front ^ 1][MATRIX_DEPTH - 1];
+  if (matrix_play == MATRIX_FRAMES) {
+    memcpy_P(back, (const Glyph *) matrix_play_data + matrix_play_index, sizeof(Glyph));
+  } else {
+    matrixTextFrame(back, (const char *) matrix_play_data, (matrix_play_length - 8) / (FONT_WIDTH + 1), matrix_play_index);
+  }
+  matrixSpread();
+  matrix_swap = true;
+  if (++matrix_play_index >= matrix_play_length) {
+    // 最後のコマは残す
+    if (matrix_play_repeat) matrix_play_index = 0; else matrix_play = MATRIX_STILL;
+  }
+  matrix_play_wait = matrix_play_period;
+}
+
+#if MONO_PROFILE & MONO_MATRIX
+// 1列をビット面ごとに描画 (Timer1 の比較一致 B。A は Servo ライブラリが定義するので使わない)
+// 明るさを下げている時は、同じ比較一致が点灯時間の終わりで消してから次のビット面を待つ
+ISR(TIMER1_COMPB_vect) {
+  static byte column = 0;
+  static byte bit = 0;
+  // 点灯時間の後で消す番と、その後のビット面の始まり
+  static boolean blanking = false;
+  static word next = 0;
+  word start = OCR1B;
+  // 他の割り込みで遅れて次の比較値を過ぎそうなら、今から数え直す
+  // (過ぎた比較値はカウンタが一周する 32ms 後まで一致せず、その間表示が止まる)
+  const word now = TCNT1;
+  if (blanking) {
+    blanking = false;
+    matrixBlank();
+    if ((word) (now - start) + MATRIX_LATE_MARGIN <= (word) (next - start)) {
+      OCR1B = next;
+      return;
+    }
+    start = now;
+  }
+  // このビット面の長さと、明るさで削った点灯時間 (カウンタは止めないので割り込みの遅れが積もらない)
+  const word slot = MATRIX_SLOT_COUNT << bit;
+  const word on = matrix_on[bit];
+  const boolean dim = on && on < slot;
+  if ((word) (now - start) + MATRIX_LATE_MARGIN > (dim ? on : slot)) start = now;
+  if (dim) {
+    OCR1B = start + on;
+    next = start + slot;
+    blanking = true;
+  } else {
+    OCR1B = start + slot;
+  }
+  if (bit == 0) {
+    if (column == 0) {
+      // 再生中ならコマを進める
+      if (matrix_play != MATRIX_STILL && !--matrix_play_wait) matrixPlayStep();
+      // フレームの先頭で入れ替え
+      if (matrix_swap) {
+        matrix_front ^= 1;
+        matrix_swap = false;
+      }
+    }
+    // 残像防止のため、列の変わり目で一旦非表示
+    matrixBlank();
+  }
+  // 行・Row（下から上へ）、列・Column（右から左へ）
+  const byte rows = on ? matrix_buffer[matrix_front][bit][column] : 0;
+  matrixWrite((word) rows << 8 | 1 << column);
+  if (++bit == MATRIX_DEPTH) {
+    bit = 0;
+    column = (column + 1) & 7;
+  }
+}
+
+#endif // MONO_MATRIX
+
+// 書き込み用の面 (最上位ビット面) を取得 (再生と入れ替え待ちは取り消す)
+byte *matrixBack() {
+  const byte sreg = SREG;
+  cli();
+  matrix_play = MATRIX_STILL;
+  matrix_swap = false;
+  byte *back = (byte *) matrix_buffer[matrix_front ^ 1][MATRIX_DEPTH - 1];
+  SREG = sreg;
+  return back;
+}
+
+// 書き込んだ面を次のフレームから最大の階調で表示
+inline void matrixSwap() {
+  matrixSpread();
+  matrix_swap = true;
+}
+
+// 全体の明るさ (0〜255、走査の周期は変えずに点灯時間を削る)
+void matrixBrightness(const byte level) {
+  word on[MATRIX_DEPTH];
+  for (byte bit = 0; bit < MATRIX_DEPTH; bit++) {
+    const word slot = MATRIX_SLOT_COUNT << bit;
+    on[bit] = level == 255 ? slot : (word) ((unsigned long) slot * level >> 8);
+    if (on[bit] < MATRIX_ON_MIN) on[bit] = 0;
+  }
+  const byte sreg = SREG;
+  cli();
+  for (byte bit = 0; bit < MATRIX_DEPTH; bit++) matrix_on[bit] = on[bit];
+  matrix_brightness = level;
+  SREG = sreg;
+}
+
+inline byte matrixBrightness() {
+  return matrix_brightness;
+}
+
+// 走査開始 (Timer1 は compareTimerBegin() で動かしておく。OCR1B はビット面ごとに割り込みで進める)
+void matrixBegin() {
+  OCR1B = TCNT1 + MATRIX_SLOT_COUNT;
+  TIFR1 = _BV(OCF1B);
+  TIMSK1 |= _BV(OCIE1B);
+}
+
+// 点灯 (1フレーム分を設定)
+void matrix(const byte pattern[8]) {
+  MONO_PROBE(PROBE_MATRIX);
+  byte *back = matrixBack();
+  for (byte column = 0; column < 8; column++) back[column] = pattern[column];
+  matrixSwap();
+}
+
+// フラッシュ上の図柄を点灯
+void matrix(const Glyph &glyph = mt::ALL_0) {
+  MONO_PROBE(PROBE_MATRIX);
+  memcpy_P(matrixBack(), &glyph, sizeof(Glyph));
+  matrixSwap();
+}
+
+// 1文字を点灯
+void matrixChar(const char c) {
+  byte *back = matrixBack();
+  // 左に1列空けて5列
+  for (byte x = 0; x < 8; x++) back[7 - x] = x ? fontColumn(c, x - 1) : 0;
+  matrixSwap();
+}
+
+// 消灯用
+void matrix_reset() {
+  matrix(mt::ALL_0);
+}
+
+// 再生を始める (1コマの長さは 4ms 単位)
+void matrixPlayStart(const MatrixPlay play, const void *data, const word length, const word frame_ms, const boolean repeat) {
+  const word period = max((frame_ms * (unsigned long) (MATRIX_COLUMN_HZ / 8) + 500) / 1000, 1UL);
+  const byte sreg = SREG;
+  cli();
+  matrix_swap = false;
+  matrix_play_data = data;
+  matrix_play_length = length;
+  matrix_play_index = 0;
+  matrix_play_period = period;
+  matrix_play_repeat = repeat;
+  // 次のフレームから
+  matrix_play_wait = 1;
+  matrix_play = length ? play : MATRIX_STILL;
+  SREG = sreg;
+}
+
+// PROGMEM の Glyph 配列をコマ送りで再生
+void matrixPlay(const Glyph *frames, const word count, const word frame_ms = 100, const boolean repeat = true) {
+  matrixPlayStart(MATRIX_FRAMES, frames, count, frame_ms, repeat);
+}
+template<size_t N> inline void matrixPlay(const Glyph (&frames)[N], const word frame_ms = 100, const boolean repeat = true) {
+  matrixPlay(frames, N, frame_ms, repeat);
+}
+
+// フラッシュ上の文字列 (F("...")) を右から左へスクロール
+void matrixScroll(const __FlashStringHelper *text, const word column_ms = 80, const boolean repeat = true) {
+  const char *data = (const char *) text;
+  // 空白8列から始めて、最後の文字が左へ抜けるまで
+  matrixPlayStart(MATRIX_TEXT, data, 8 + strlen_P(data) * (FONT_WIDTH + 1), column_ms, repeat);
+}
+
+// 再生中は true
+inline boolean isMatrixPlaying() {
+  return matrix_play != MATRIX_STILL;
+}
+
+// 階調の書き込み用の1点を設定 (x は左から、y は上から、level は 0〜15)
+inline void matrixPixel(const byte x, const byte y, const byte level) {
+  if (x < 8 && y < 8) matrix_gray[y][x] = min(level, MATRIX_LEVEL_MAX);
+}
+
+inline byte matrixPixel(const byte x, const byte y) {
+  return x < 8 && y < 8 ? matrix_gray[y][x] : 0;
+}
+
+// 階調の書き込み用を全て level に
+void matrixGrayFill(const byte level = 0) {
+  memset(matrix_gray, min(level, MATRIX_LEVEL_MAX), sizeof(matrix_gray));
+}
+
+// 階調の書き込み用をビット面に分けて、次のフレームから表示
+void matrixGrayShow() {
+  // 再生と入れ替え待ちを取り消してから
+  matrixBack();
+  byte (*back)[8] = (byte (*)[8]) matrix_buffer[matrix_front ^ 1];
+  for (byte column = 0; column < 8; column++) {
+    // column[0] が右端
+    const byte x = 7 - column;
+    for (byte bit = 0; bit < MATRIX_DEPTH; bit++) {
+      byte rows = 0;
+      for (byte y = 0; y < 8; y++) if (matrix_gray[y][x] >> bit & 1) rows |= 1 << y;
+      back[bit][column] = rows;
+    }
   }
+  matrix_swap = true;
 }
 
 /************
@@ -384,16 +2037,22 @@ void matrix(const byte pattern[8] = mt::ALL_0) {
 // 各線の列挙型
 enum Line : word { P1 = 0x001, P2 = 0x002, P3 = 0x004, P4 = 0x008, P5 = 0x010, P6 = 0x020, P7 = 0x040, P8 = 0x080, P9 = 0x100, P10 = 0x200 };
 struct BarPins { byte pin; Line line; };
-const BarPins bar_pins[] = { { LED_BAR_1_PIN, P1 }, { LED_BAR_2_PIN, P2 }, { LED_BAR_3_PIN, P3 }, { LED_BAR_4_PIN, P4 }, { LED_BAR_5_PIN, P5 }, { LED_BAR_6_PIN, P6 }, { LED_BAR_7_PIN, P7 }, { LED_BAR_8_PIN, P8 }, { LED_BAR_9_PIN, P9 }, { LED_BAR_10_PIN, P10 } };
+namespace flash { const BarPins bar_pins[] PROGMEM = { { LED_BAR_1_PIN, P1 }, { LED_BAR_2_PIN, P2 }, { LED_BAR_3_PIN, P3 }, { LED_BAR_4_PIN, P4 }, { LED_BAR_5_PIN, P5 }, { LED_BAR_6_PIN, P6 }, { LED_BAR_7_PIN, P7 }, { LED_BAR_8_PIN, P8 }, { LED_BAR_9_PIN, P9 }, { LED_BAR_10_PIN, P10 } }; }
+constexpr auto bar_pins = flashTable(flash::bar_pins);
 // 各色の格納変数
-const Line lineIndex[] = { P1, P2, P3, P4, P5, P6, P7, P8, P9, P10 };
+namespace flash { const Line lineIndex[] PROGMEM = { P1, P2, P3, P4, P5, P6, P7, P8, P9, P10 }; }
+constexpr auto lineIndex = flashTable(flash::lineIndex);
 // 下から上
-const Line lineBottomIndex[] = { P10, P9, P8, P7, P6, P5, P4, P3, P2, P1 };
+namespace flash { const Line lineBottomIndex[] PROGMEM = { P10, P9, P8, P7, P6, P5, P4, P3, P2, P1 }; }
+constexpr auto lineBottomIndex = flashTable(flash::lineBottomIndex);
 
 // 各色の列挙型
-enum Rgb { R = 0x1, G = 0x2, B = 0x4 };
+enum Rgb : byte { R = 0x1, G = 0x2, B = 0x4 };
 struct RgbPins { byte pin; Rgb color; };
-const RgbPins rgb_pins[] = { { LED_RED_PIN, R }, { LED_GREEN_PIN, G }, { LED_BLUE_PIN, B } };
+namespace flash { const RgbPins rgb_pins[] PROGMEM = { { LED_RED_PIN, R }, { LED_GREEN_PIN, G }, { LED_BLUE_PIN, B } }; }
+constexpr auto rgb_pins = flashTable(flash::rgb_pins);
+// 10本 + RGB のピン (Line のビット順の後に R, G, B。PORTA, E, G, H)
+typedef PinGroup<LED_BAR_1_PIN, LED_BAR_2_PIN, LED_BAR_3_PIN, LED_BAR_4_PIN, LED_BAR_5_PIN, LED_BAR_6_PIN, LED_BAR_7_PIN, LED_BAR_8_PIN, LED_BAR_9_PIN, LED_BAR_10_PIN, LED_RED_PIN, LED_GREEN_PIN, LED_BLUE_PIN> BarPort;
 // 白（ホワイト）
 const Rgb W = (Rgb) (R | G | B);
 // 水色（シアン）
@@ -405,66 +2064,513 @@ const Rgb M = (Rgb) (R | B);
 // 消灯（ブラック）
 const Rgb K = (Rgb) 0;
 // 各色の格納変数
-const byte rgbIndex[] = { R, G, B, W, C, Y, M, K };
+namespace flash { const byte rgbIndex[] PROGMEM = { R, G, B, W, C, Y, M, K }; }
+constexpr auto rgbIndex = flashTable(flash::rgbIndex);
+
+// 24bit の色 (各 0〜255)
+struct Color { byte r; byte g; byte b; };
+constexpr Color rgb(const byte r, const byte g, const byte b) {
+  return Color { r, g, b };
+}
+// 0xRRGGBB から
+constexpr Color rgb(const unsigned long hex) {
+  return Color { (byte) (hex >> 16), (byte) (hex >> 8), (byte) hex };
+}
+inline bool operator==(const Color &a, const Color &b) {
+  return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+// 本数
+const byte BAR_COUNT = 10;
+// 1枠の長さ [ティック] (10枠で 5ms、200Hz で一巡)
+const byte BAR_SLOT_TICKS = 5;
+const byte BAR_FRAME_TICKS = BAR_COUNT * BAR_SLOT_TICKS;
+
+// 1本ごとの色 (8.8 固定小数点) と、フェードの1フレームの増分・目標・残りフレーム数
+struct BarFade { word level[3]; int step[3]; byte to[3]; word left; };
+static BarFade bar_fade[BAR_COUNT];
+// 色ごとにまとめた枠 (割り込みがフレームの頭で作る)
+static word bar_slot_lines[BAR_COUNT];
+static Color bar_slot_color[BAR_COUNT];
+static byte bar_slot_count = 0;
+static byte bar_slot = BAR_COUNT - 1;
+static byte bar_tick = 0;
+// 時分割で点灯中 (bar() で止まる)
+static volatile boolean bar_mux = false;
+// 青をソフトウェアで PWM 中と、周期の頭から Low にするまでの Timer1 のカウント数
+static boolean bar_blue_pwm = false;
+static word bar_blue_at = 0;
+// 青を Low にする比較一致までの最短のカウント数 (過ぎていれば割り込みの後すぐ)
+const byte BAR_BLUE_LEAD = 4;
+
+// 明るさ 0〜255 を Timer4 の1周期中の点灯カウント数に
+inline word barCounts(const byte level) {
+  return (unsigned long) (level + 1) * (TICK_TOP + 1) >> 8;
+}
+
+// フェードを1フレーム進め、同じ色の線を1枠にまとめる (割り込みから呼ばれる)
+inline void barFrame() {
+  bar_slot_count = 0;
+  for (byte i = 0; i < BAR_COUNT; i++) {
+    BarFade &fade = bar_fade[i];
+    if (fade.left) {
+      // 最後のフレームで丸め誤差を捨てて目標に合わせる
+      if (--fade.left) for (byte c = 0; c < 3; c++) fade.level[c] += fade.step[c];
+      else for (byte c = 0; c < 3; c++) fade.level[c] = (word) fade.to[c] << 8;
+    }
+    const Color color = rgb(fade.level[0] >> 8, fade.level[1] >> 8, fade.level[2] >> 8);
+    if (!(color.r | color.g | color.b)) continue;
+    byte slot = 0;
+    while (slot < bar_slot_count && !(bar_slot_color[slot] == color)) slot++;
+    if (slot == bar_slot_count) {
+      bar_slot_color[slot] = color;
+      bar_slot_lines[slot] = 0;
+      bar_slot_count++;
+    }
+    bar_slot_lines[slot] |= 1 << i;
+  }
+}
+
+// 青を Low にする比較一致を Timer1 に設定 (8分周なので、Timer4 の周期の頭からの経過を 1/8 にして引く)
+inline void barBlueSchedule() {
+  const word elapsed = TCNT4 >> 3;
+  const word wait = bar_blue_at > elapsed + BAR_BLUE_LEAD ? bar_blue_at - elapsed : BAR_BLUE_LEAD;
+  OCR1C = TCNT1 + wait;
+  TIFR1 = _BV(OCF1C);
+}
+
+// 時分割と PWM (Timer4 のオーバーフロー毎に呼ばれる)
+// 赤・緑は OC4B, OC4C の反転 PWM、青 (OC2B は tone() の Timer2) は Timer1 の比較一致 C で Low にして周期の頭で戻す
+// (Timer4 の比較一致 A は Servo ライブラリが定義するので使わない)
+inline void barTick() {
+  if (!bar_mux) return;
+  if (bar_blue_pwm) LED_BLUE_PIN.high();
+  if (++bar_tick == BAR_SLOT_TICKS - 1) {
+    // 比較値は次の BOTTOM で反映されるので、1ティック前に次の枠の分を設定
+    if (++bar_slot == BAR_COUNT) {
+      bar_slot = 0;
+      barFrame();
+    }
+    if (bar_slot < bar_slot_count) {
+      const Color color = bar_slot_color[bar_slot];
+      OCR4B = barCounts(color.r) - 1;
+      OCR4C = barCounts(color.g) - 1;
+    }
+  } else if (bar_tick == BAR_SLOT_TICKS) {
+    bar_tick = 0;
+    word lines = 0;
+    byte tccr = _BV(WGM41);
+    byte blue = 0;
+    if (bar_slot < bar_slot_count) {
+      lines = bar_slot_lines[bar_slot];
+      const Color color = bar_slot_color[bar_slot];
+      if (color.r) tccr |= _BV(COM4B1) | _BV(COM4B0);
+      if (color.g) tccr |= _BV(COM4C1) | _BV(COM4C0);
+      blue = color.b;
+      bar_blue_at = (TICK_TOP + 1 - barCounts(blue)) >> 3;
+    }
+    TCCR4A = tccr;
+    // 使わない色は High (消灯)、青が最大の時だけ Low
+    BarPort::write(lines | (word) (blue == 255 ? R | G : W) << 10);
+    const boolean pwm = blue && blue != 255;
+    if (!pwm && bar_blue_pwm) TIMSK1 &= ~_BV(OCIE1C);
+    else if (pwm && !bar_blue_pwm) TIMSK1 |= _BV(OCIE1C);
+    bar_blue_pwm = pwm;
+  }
+  if (bar_blue_pwm) barBlueSchedule();
+}
+
+#if MONO_PROFILE & MONO_BAR
+// 青の点灯 (周期の残り)
+ISR(TIMER1_COMPC_vect) {
+  LED_BLUE_PIN.low();
+}
+#endif // MONO_BAR
 
 // LEDバー制御関数
 void bar(const word line = 0, const byte color = 0) {
-  for (const auto& led : bar_pins)
-    digitalWrite(led.pin, (line & led.line) ? HIGH : LOW);
-  for (const auto& rgb : rgb_pins)
-    digitalWrite(rgb.pin, !(color & rgb.color));
+  MONO_PROBE(PROBE_BAR);
+  const byte sreg = SREG;
+  cli();
+  // 時分割を止めて全部同じ色で常時点灯
+  if (bar_mux) {
+    bar_mux = false;
+    bar_blue_pwm = false;
+    TIMSK1 &= ~_BV(OCIE1C);
+    TCCR4A = _BV(WGM41);
+  }
+  // 後からフェードする時の始まりの色
+  for (byte i = 0; i < BAR_COUNT; i++) {
+    BarFade &fade = bar_fade[i];
+    fade.left = 0;
+    for (byte c = 0; c < 3; c++) fade.level[c] = (line >> i & 1) && (color >> c & 1) ? 0xFF00 : 0;
+  }
+  // RGB は減算方式なので反転 (同じ値なら何も書かない)
+  BarPort::stage((line & 0x3FF) | (word) (~color & W) << 10);
+  SREG = sreg;
+  outputFlush();
 }
 
+// line の色を ms かけて color へ変える (割り込みで進む。時分割になるので1本の明るさは bar() の 1/10)
+void barFade(const word line, const Color color, const word ms) {
+  const word frames = ((unsigned long) ms * (TICK_HZ / 1000) + BAR_FRAME_TICKS / 2) / BAR_FRAME_TICKS;
+  const byte to[3] = { color.r, color.g, color.b };
+  for (byte i = 0; i < BAR_COUNT; i++) {
+    if (!(line >> i & 1)) continue;
+    BarFade &fade = bar_fade[i];
+    const byte sreg = SREG;
+    cli();
+    for (byte c = 0; c < 3; c++) {
+      fade.to[c] = to[c];
+      if (frames < 2) fade.level[c] = (word) to[c] << 8;
+      else fade.step[c] = ((long) ((word) to[c] << 8) - fade.level[c]) / frames;
+    }
+    fade.left = frames < 2 ? 0 : frames;
+    SREG = sreg;
+  }
+  if (!bar_mux) {
+    const byte sreg = SREG;
+    cli();
+    // 以降は割り込みが出力する
+    BarPort::discard();
+    bar_tick = 0;
+    bar_slot = BAR_COUNT - 1;
+    bar_mux = true;
+    SREG = sreg;
+  }
+}
+
+// line をすぐに color に
+inline void barColor(const word line, const Color color) {
+  barFade(line, color, 0);
+}
+
+// 上 (P1) の top から下 (P10) の bottom へのグラデーションに ms かけて変える
+void barGradient(const Color top, const Color bottom, const word ms = 0) {
+  for (byte i = 0; i < BAR_COUNT; i++) {
+    // 7bit の比率 (int が 16bit でも溢れない)
+    const int k = i * 128 / (BAR_COUNT - 1);
+    barFade(lineIndex[i], rgb(top.r + ((bottom.r - top.r) * k >> 7), top.g + ((bottom.g - top.g) * k >> 7), top.b + ((bottom.b - top.b) * k >> 7)), ms);
+  }
+}
+
+// フェード中は true
+boolean isBarFading() {
+  boolean fading = false;
+  const byte sreg = SREG;
+  cli();
+  for (byte i = 0; i < BAR_COUNT; i++) if (bar_fade[i].left) fading = true;
+  SREG = sreg;
+  return fading;
+}
+
+/***************
+ * 入力イベント *
+ ***************/
+
+// 入力の番号 (タクトスイッチは TactSwitch と同じ順)
+enum InputSource : byte { IN_TL, IN_TR, IN_LL, IN_LR, IN_RL, IN_RR, IN_TOGGLE, IN_PHOTO };
+// チャタリングとみなす時間 [ティック]
+namespace flash { const byte INPUT_DEBOUNCE[] PROGMEM = { 50, 50, 50, 50, 50, 50, 100, 2 }; }
+constexpr auto INPUT_DEBOUNCE = flashTable(flash::INPUT_DEBOUNCE);
+// 変化点 (enabled は押された・上げられた・遮られた側か)
+struct InputEvent { InputSource source; boolean enabled; unsigned long time; };
+// 取り出されていない変化点 (2 の累乗個。中身も volatile にして、head を進める前に書き終える)
+const byte INPUT_QUEUE_SIZE = 16;
+static volatile InputEvent input_queue[INPUT_QUEUE_SIZE];
+static volatile byte input_head = 0;
+static volatile byte input_tail = 0;
+// 溢れて捨てた数
+static volatile byte input_dropped = 0;
+// チャタリング除去後の状態と最後に変化した時刻
+static volatile byte input_state = 0;
+static word input_time[8];
+
+// 入力の記録と再生の状態
+enum TraceMode : byte { TRACE_OFF, TRACE_RECORD, TRACE_REPLAY };
+static volatile TraceMode trace_mode = TRACE_OFF;
+// 記録した最後のピンの状態 (再生中はピンの代わりに使う)
+static volatile byte trace_level = 0;
+
+// 各入力の状態 (bit = InputSource、1 が有効側)
+inline byte inputLevel() {
+  return (TACT_TEST_LEFT_PIN.read() ? _BV(IN_TL) : 0) | (TACT_TEST_RIGHT_PIN.read() ? _BV(IN_TR) : 0)
+       | (TACT_LEFT_LEFT_PIN.read() ? _BV(IN_LL) : 0) | (TACT_LEFT_RIGHT_PIN.read() ? _BV(IN_LR) : 0)
+       | (TACT_RIGHT_LEFT_PIN.read() ? _BV(IN_RL) : 0) | (TACT_RIGHT_RIGHT_PIN.read() ? _BV(IN_RR) : 0)
+       | (TOGGLE_PIN.read() ? _BV(IN_TOGGLE) : 0) | (!PHOTO_INTERRUPTER_PIN.read() ? _BV(IN_PHOTO) : 0);
+}
+
+// フォトインタラプタが遮られた時刻を回転計へ
+void tachEdge(const unsigned long now);
+
+// 変化点を検出して積む (割り込みから呼ぶ)
+inline void inputSample() {
+  const byte changed = (trace_mode == TRACE_REPLAY ? trace_level : inputLevel()) ^ input_state;
+  if (!changed) return;
+  const unsigned long now = tick_count;
+  for (byte i = 0; i < 8; i++) {
+    if (!(changed & _BV(i))) continue;
+    // 直前の変化から一定時間は無視 (その後のティックで改めて判定)
+    if ((word) ((word) now - input_time[i]) < INPUT_DEBOUNCE[i]) continue;
+    input_time[i] = now;
+    input_state ^= _BV(i);
+    if (i == IN_PHOTO && (input_state & _BV(IN_PHOTO))) tachEdge(now);
+    const byte head = input_head;
+    const byte next = (head + 1) & (INPUT_QUEUE_SIZE - 1);
+    if (next == input_tail) {
+      if (input_dropped < 255) input_dropped++;
+      continue;
+    }
+    volatile InputEvent &event = input_queue[head];
+    event.source = (InputSource) i;
+    event.enabled = (input_state >> i) & 1;
+    event.time = now;
+    input_head = next;
+  }
+}
+
+// 変化点を1つ取り出す (無ければ false)
+boolean inputNext(InputEvent &event) {
+  const byte tail = input_tail;
+  if (tail == input_head) return false;
+  const volatile InputEvent &queued = input_queue[tail];
+  event.source = queued.source;
+  event.enabled = queued.enabled;
+  event.time = queued.time;
+  input_tail = (tail + 1) & (INPUT_QUEUE_SIZE - 1);
+  return true;
+}
+
+// 未処理の有効側への変化の回数
+static byte input_count[8];
+
+// 変化点を全て取り出して数える
+void inputPoll() {
+  InputEvent event;
+  while (inputNext(event)) {
+    if (event.enabled && input_count[event.source] < 255) input_count[event.source]++;
+  }
+}
+
+// 有効側への変化を1回分消費 (無ければ false)
+boolean inputTake(const InputSource source) {
+  inputPoll();
+  if (!input_count[source]) return false;
+  input_count[source]--;
+  return true;
+}
+
+// ピン変化割り込み (ピン 50〜52) とティックで監視を開始
+void inputBegin() {
+  // 起動時に押されているタクトスイッチは押下とみなさない
+  input_state = inputLevel() & (_BV(IN_TOGGLE) - 1);
+  PCMSK0 |= TACT_LEFT_RIGHT_PIN.MASK | TACT_RIGHT_LEFT_PIN.MASK | TACT_RIGHT_RIGHT_PIN.MASK;
+  PCIFR = _BV(PCIF0);
+  PCICR |= _BV(PCIE0);
+}
+
+#if MONO_PROFILE & MONO_INPUT
+// ピン 50〜52 の変化は即座に
+ISR(PCINT0_vect) {
+  inputSample();
+}
+#endif // MONO_INPUT
+
 /********************
  * フォトインタラプタ *
  ********************/
 
 // フォトインタラプタが反応し続けている時は true
 inline boolean isPhotoEnabled() {
-  return digitalRead(PHOTO_INTERRUPTER_PIN) == LOW;
+  if (trace_mode == TRACE_REPLAY) return trace_level & _BV(IN_PHOTO);
+  return !PHOTO_INTERRUPTER_PIN.read();
 }
 
 // フォトインタラプタの羽が指定回数通過した瞬間に true
 boolean isPhotoPassed(const byte rotation = 1) {
-  // 瞬間検知のための状態保持フラグ
-  static boolean photo_state = false;
   // 通過回数カウンター
   static byte photo_passed_count = 0;
-  // 羽が1枚通過した瞬間かを判定
-  boolean one_rotate = false;
-  // 現在の遮光状態を一度だけ読み取る
-  boolean currently_enabled = isPhotoEnabled();
-  // 通過の瞬間を検知
-  if (!photo_state && currently_enabled) {
-    // 状態を検知済みに更新
-    photo_state = true;
-    // 1回通過したと判定
-    one_rotate = true;
-  }
-  // 状態をリセット
-  else if (!currently_enabled) {
-    // 状態を未検知にリセット
-    photo_state = false;
-  }
-  // 1回通過を検知した場合のみ回数判断へ
-  if (!one_rotate) {
-    return false;
-  }
-  // 1回通過が検知された場合
-  if (rotation == 1) {
-    // 目標が1回なら、そのまま true
-    return true;
-  } else {
-    // 目標が複数回なら、カウンター処理を行う
-    photo_passed_count++;
-    if (photo_passed_count >= rotation) {
-      photo_passed_count = 0;
-      // 目標回数に到達した
-      return true;
-    }
-  }
+  // 取りこぼさないよう、遮られた回数を割り込みで記録したものから数える
+  while (photo_passed_count < rotation && inputTake(IN_PHOTO)) photo_passed_count++;
   // 目標回数に達していない場合は false
-  return false;
+  if (photo_passed_count < rotation) return false;
+  photo_passed_count = 0;
+  return true;
+}
+
+// 回転計
+// 羽の枚数
+static byte tach_blades = 1;
+// この時間羽が来なければ停止とみなす [ティック]
+const word TACH_STALL_TICKS = TICK_HZ / 2;
+// 平滑化の強さ (1/2^TACH_FILTER_SHIFT ずつ新しい周期に寄せる)
+const byte TACH_FILTER_SHIFT = 3;
+// 最後に遮られた時刻と直前の周期 [ティック]
+static unsigned long tach_last = 0;
+static word tach_period = 0;
+// 周期の平均と、平均からのずれの平均 (2^TACH_FILTER_SHIFT 倍で保持)
+static long tach_average = 0;
+static long tach_jitter = 0;
+// 遮られた回数
+static unsigned long tach_count = 0;
+
+// 羽が遮る度に周期を更新 (割り込みから呼ばれる)
+void tachEdge(const unsigned long now) {
+  const unsigned long period = now - tach_last;
+  tach_last = now;
+  tach_count++;
+  // 止まっていた後の最初の1枚は周期にならない
+  if (tach_count == 1 || period > TACH_STALL_TICKS) {
+    tach_period = 0;
+    tach_average = 0;
+    tach_jitter = 0;
+    return;
+  }
+  tach_period = period;
+  const long scaled = (long) period << TACH_FILTER_SHIFT;
+  if (!tach_average) {
+    tach_average = scaled;
+    return;
+  }
+  const long error = scaled - tach_average;
+  tach_average += error >> TACH_FILTER_SHIFT;
+  tach_jitter += (labs(error) - tach_jitter) >> TACH_FILTER_SHIFT;
+}
+
+// 羽の枚数を設定
+void tachBlades(const byte blades) {
+  tach_blades = max(blades, 1);
+}
+
+// 回転が止まっている (一定時間羽が来ていない) 時は true
+boolean isTachStalled() {
+  const byte sreg = SREG;
+  cli();
+  const boolean stalled = !tach_period || tick_count - tach_last > TACH_STALL_TICKS;
+  SREG = sreg;
+  return stalled;
+}
+
+// 直前の1周期から求めた回転数 [rpm]
+word tachRpm() {
+  if (isTachStalled()) return 0;
+  const byte sreg = SREG;
+  cli();
+  const word period = tach_period;
+  SREG = sreg;
+  return 60UL * TICK_HZ / ((unsigned long) period * tach_blades);
+}
+
+// 平均の回転数 [rpm]
+word tachAverageRpm() {
+  if (isTachStalled()) return 0;
+  const byte sreg = SREG;
+  cli();
+  const unsigned long average = tach_average;
+  SREG = sreg;
+  return (60UL * TICK_HZ << TACH_FILTER_SHIFT) / (average * tach_blades);
+}
+
+// 周期のばらつき (平均からのずれの平均) [us]
+word tachJitter() {
+  if (isTachStalled()) return 0;
+  const byte sreg = SREG;
+  cli();
+  const unsigned long jitter = tach_jitter;
+  SREG = sreg;
+  return (jitter * (1000000UL / TICK_HZ)) >> TACH_FILTER_SHIFT;
+}
+
+/***********************
+ * DCモーターの速度制御 *
+ ***********************/
+
+// 制御周期 [ティック] (100Hz)
+const byte DC_CONTROL_TICKS = 100;
+// ゲイン (デューティ比 / rpm の 4096 倍、積分は1周期あたり)
+static long dc_kp = 246;
+static long dc_ki = 20;
+static long dc_kd = 0;
+// 積分値と前回の回転数
+static long dc_integral = 0;
+static word dc_last_rpm = 0;
+// 目標 ±DC_SETTLE_PERCENT% に DC_SETTLE_TICKS 留まったら整定とみなす
+const byte DC_SETTLE_PERCENT = 5;
+const word DC_SETTLE_TICKS = 3000;
+// 目標を設定した時刻と、最後に範囲を外れていた時刻
+static unsigned long dc_target_time = 0;
+static unsigned long dc_outside_time = 0;
+static volatile boolean dc_settled = false;
+
+// 目標回転数に合わせてデューティ比を決める (割り込みから呼ばれる)
+inline void dcControlTick() {
+  static byte count = 0;
+  const word target = dc_target;
+  if (!target || ++count < DC_CONTROL_TICKS) return;
+  count = 0;
+  const unsigned long now = tick_count;
+  // 直前の1周期から回転数を求める (停止中は 0)
+  const word rpm = (!tach_period || now - tach_last > TACH_STALL_TICKS) ? 0 : 60UL * TICK_HZ / ((unsigned long) tach_period * tach_blades);
+  const int error = (int) target - (int) rpm;
+  // 積分は出力の範囲で止める (ワインドアップ防止)
+  dc_integral = constrain(dc_integral + dc_ki * error, 0L, 255L << 12);
+  // 微分は回転数側で取り、目標変更時に跳ねないようにする
+  const long output = dc_kp * error + dc_integral - dc_kd * ((int) rpm - (int) dc_last_rpm);
+  dc_last_rpm = rpm;
+  dc_duty = constrain(output, 0L, 255L << 12) >> 12;
+  // 整定の判定
+  if ((unsigned long) abs(error) * 100 > (unsigned long) target * DC_SETTLE_PERCENT) dc_outside_time = now;
+  dc_settled = now - dc_outside_time >= DC_SETTLE_TICKS;
+}
+
+// ゲインを設定 (kp [1/rpm], ki [1/(rpm s)], kd [s/rpm] でデューティ比 0〜255 を出す)
+void dcTune(const float kp, const float ki, const float kd) {
+  const byte sreg = SREG;
+  cli();
+  dc_kp = kp * 4096.0f;
+  dc_ki = ki * 4096.0f * DC_CONTROL_TICKS / TICK_HZ;
+  dc_kd = kd * 4096.0f * TICK_HZ / DC_CONTROL_TICKS;
+  SREG = sreg;
+}
+
+// DC モーターを目標回転数で回す (LT, RT 以外は dc と同じ)
+void dcSpeed(const DCMotor action, const word rpm) {
+  if ((action != LT && action != RT) || !rpm) {
+    dc(action == LT || action == RT ? F : action);
+    return;
+  }
+  const byte sreg = SREG;
+  cli();
+  // 止まっていた・向きが変わった時は積分をやり直す
+  if (!dc_target || dc_pwm_action != action) {
+    dc_integral = 0;
+    dc_last_rpm = 0;
+  }
+  dc_target = rpm;
+  dc_pwm_action = action;
+  dc_target_time = dc_outside_time = tick_count;
+  dc_settled = false;
+  SREG = sreg;
+}
+
+// 目標回転数の範囲に落ち着いたら true
+inline boolean isDcSettled() {
+  return dc_target && dc_settled;
+}
+
+// 目標を設定してから範囲に入ったままになるまでの時間 [ms] (整定前は 0)
+unsigned long dcSettleTime() {
+  if (!isDcSettled()) return 0;
+  const byte sreg = SREG;
+  cli();
+  const unsigned long time = dc_outside_time - dc_target_time;
+  SREG = sreg;
+  return time * 1000 / TICK_HZ;
+}
+
+// 定常偏差 (目標 - 平均の回転数) [rpm]
+inline int dcSpeedError() {
+  return dc_target ? (int) dc_target - (int) tachAverageRpm() : 0;
 }
 
 /*****************
@@ -473,28 +2579,13 @@ boolean isPhotoPassed(const byte rotation = 1) {
 
 // トグルスイッチが奥側の時は true
 inline boolean isToggleEnabled() {
-  return digitalRead(TOGGLE_PIN) == HIGH;
+  if (trace_mode == TRACE_REPLAY) return trace_level & _BV(IN_TOGGLE);
+  return TOGGLE_PIN.read();
 }
 
 // トグルスイッチが上げられた時に true
 boolean isTogglePulled() {
-  // トグルの状態保持用
-  static boolean toggle = true;
-  // 現在の状態を取得
-  boolean currently_enabled = isToggleEnabled();
-  // トグルの状態を参照し更新
-  if (currently_enabled && toggle) {
-    // 上げられたので状態を更新
-    toggle = false;
-    return true;
-  } else if (!currently_enabled) {
-    // 下げられたので状態をリセット
-    toggle = true;
-    return false;
-  } else {
-    // 上げられているが無視
-    return false;
-  }
+  return inputTake(IN_TOGGLE);
 }
 
 /*****************
@@ -504,31 +2595,86 @@ boolean isTogglePulled() {
 // タクトスイッチの左右を識別する列挙型
 enum TactSwitch { TL, TR, LL, LR, RL, RR };
 // タクトスイッチの全ピン（列挙型変数に対応）
-const byte TACT_PINS[] = { TACT_TEST_LEFT_PIN, TACT_TEST_RIGHT_PIN, TACT_LEFT_LEFT_PIN, TACT_LEFT_RIGHT_PIN, TACT_RIGHT_LEFT_PIN, TACT_RIGHT_RIGHT_PIN };
+namespace flash { const byte TACT_PINS[] PROGMEM = { TACT_TEST_LEFT_PIN, TACT_TEST_RIGHT_PIN, TACT_LEFT_LEFT_PIN, TACT_LEFT_RIGHT_PIN, TACT_RIGHT_LEFT_PIN, TACT_RIGHT_RIGHT_PIN }; }
+constexpr auto TACT_PINS = flashTable(flash::TACT_PINS);
 
 // 指定された側のタクトスイッチが押され続けている時は true
 boolean isTactEnabled(const TactSwitch side) {
-  return digitalRead(TACT_PINS[side]);
+  // 並びは InputSource と同じ
+  if (trace_mode == TRACE_REPLAY) return trace_level & _BV(side);
+  switch (side) {
+    case TL: return TACT_TEST_LEFT_PIN.read();
+    case TR: return TACT_TEST_RIGHT_PIN.read();
+    case LL: return TACT_LEFT_LEFT_PIN.read();
+    case LR: return TACT_LEFT_RIGHT_PIN.read();
+    case RL: return TACT_RIGHT_LEFT_PIN.read();
+    default: return TACT_RIGHT_RIGHT_PIN.read();
+  }
 }
 
 // 指定された側のタクトスイッチが１回押された時に true
 boolean isTactPressed(const TactSwitch side) {
-  // スイッチの状態保持用
-  static boolean tact_pressed_state[6] = { LOW, LOW, LOW, LOW, LOW, LOW };
-  boolean currently_enabled = isTactEnabled(side);
-  // 指定されたスイッチの状態を参照し更新
-  if (currently_enabled && tact_pressed_state[side]) {
-    // 押されたので状態を更新
-    tact_pressed_state[side] = false;
-    return true;
-  } else if (!currently_enabled) {
-    // 離されたので状態をリセット
-    tact_pressed_state[side] = true;
-    return false;
-  } else {
-    // 押され続けているが無視
-    return false;
+  return inputTake((InputSource) side);
+}
+
+/***********
+ * AD 変換 *
+ ***********/
+
+// 変換完了割り込みで順に読み続けるチャンネル (getAdc の番号順)
+namespace flash { const byte ADC_PINS[] PROGMEM = { POTENTIOMETER_PIN, JOYSTICK_X_PIN, JOYSTICK_Y_PIN }; }
+constexpr auto ADC_PINS = flashTable(flash::ADC_PINS);
+enum AdcIndex : byte { ADC_POT, ADC_JOY_X, ADC_JOY_Y };
+// 平滑化の強さ (1/2^ADC_FILTER_SHIFT ずつ新しい値に寄せる)
+const byte ADC_FILTER_SHIFT = 4;
+// 各チャンネルの値 (2^ADC_FILTER_SHIFT 倍で保持)
+static volatile word adc_filter[ADC_PINS.size()];
+// 変換中のチャンネル
+static byte adc_index = 0;
+
+// チャンネルを選んで変換開始 (AVcc 基準)
+inline void adcStart(const byte pin) {
+  const byte channel = pin - A0;
+  ADMUX = _BV(REFS0) | (channel & 0x07);
+  ADCSRB = (ADCSRB & ~_BV(MUX5)) | ((channel & 0x08) ? _BV(MUX5) : 0);
+  ADCSRA |= _BV(ADSC);
+}
+
+#if MONO_PROFILE & MONO_ADC
+// 変換完了 (約 104us 毎、チャンネル毎には約 3kHz)
+ISR(ADC_vect) {
+  const word sample = ADC;
+  const word value = adc_filter[adc_index];
+  // 指数移動平均 (再生中は記録された値を使う)
+  if (trace_mode != TRACE_REPLAY) adc_filter[adc_index] = value - (value >> ADC_FILTER_SHIFT) + sample;
+  if (++adc_index >= ADC_PINS.size()) adc_index = 0;
+  adcStart(ADC_PINS[adc_index]);
+}
+#endif // MONO_ADC
+
+// 平滑化済みの値を 0 ~ 1023 で取得 (割り込みを止めずに読む)
+inline word getAdc(const AdcIndex index) {
+  word value;
+  do {
+    value = adc_filter[index];
+  } while (value != adc_filter[index]);
+  return (value + (1 << (ADC_FILTER_SHIFT - 1))) >> ADC_FILTER_SHIFT;
+}
+
+// 割り込みによる連続変換を開始 (以降 ADC_PINS に analogRead は使わない)
+void adcBegin() {
+  // 1/128 分周 (125kHz)
+  ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+  // 最初の値は待って読む (1ms 未満)
+  for (byte i = 0; i < ADC_PINS.size(); i++) {
+    adcStart(ADC_PINS[i]);
+    while (ADCSRA & _BV(ADSC));
+    adc_filter[i] = ADC << ADC_FILTER_SHIFT;
   }
+  // 以降は変換完了割り込みで (完了フラグは 1 を書いて消す)
+  adc_index = 0;
+  ADCSRA |= _BV(ADIF) | _BV(ADIE);
+  adcStart(ADC_PINS[0]);
 }
 
 /*************
@@ -537,13 +2683,23 @@ boolean isTactPressed(const TactSwitch side) {
 
 // 可変抵抗器の値を 0 ~ 1023 で取得
 inline word getPot() {
-  return analogRead(POTENTIOMETER_PIN);
+  return getAdc(ADC_POT);
 }
 
+// 7セグの数字が切り替わるのに必要な余裕
+const word POT_HYSTERESIS = 8;
+
 // 可変抵抗器と7セグを同期
 void syncPot() {
+  MONO_PROBE(PROBE_SYNC_POT);
+  static byte digit = 0;
+  const word value = getPot();
   // 1023 -> 9
-  seg(num[map(getPot(), 0, 896, 0, 9)]);
+  const byte next = map(value, 0, 896, 0, 9);
+  // 境界付近では余裕を超えるまで前の数字のまま
+  if (next > digit && map(value - min(value, POT_HYSTERESIS), 0, 896, 0, 9) > digit) digit = next;
+  if (next < digit && map(value + POT_HYSTERESIS, 0, 896, 0, 9) < digit) digit = next;
+  seg(num[digit]);
 }
 
 /*******************
@@ -552,11 +2708,11 @@ void syncPot() {
 
 // X軸の値を取得
 inline word getJoyX() {
-  return analogRead(JOYSTICK_X_PIN);
+  return getAdc(ADC_JOY_X);
 }
 // Y軸の値を取得
 inline word getJoyY() {
-  return analogRead(JOYSTICK_Y_PIN);
+  return getAdc(ADC_JOY_Y);
 }
 // 調整値
 const word JOYSTICK_DEAD_ZONE = 250;
@@ -566,6 +2722,7 @@ const word THRESHOLD_LOW  = 100 + JOYSTICK_DEAD_ZONE;
 const word THRESHOLD_HIGH = 900 - JOYSTICK_DEAD_ZONE;
 // LED マトリックスと向きを同期
 void syncArrow() {
+  MONO_PROBE(PROBE_SYNC_ARROW);
   // X軸
   word xValue = getJoyX();
   // Y軸
@@ -583,6 +2740,856 @@ void syncArrow() {
   }
 }
 
+/*******************
+ * 入力の記録と再生 *
+ *******************/
+
+// 変化点の1バイト目は種類 (上位3ビット) と前の変化点からのティック数 (下位5ビット)
+// ティック数が TRACE_WAIT_LONG 以上なら残りを可変長 (7ビットずつ) で続け、その後に値
+// (ピンは1バイト、AD 変換値は前の値との差をジグザグ符号化した可変長)
+enum TraceKind : byte { TRACE_LEVEL, TRACE_POT, TRACE_JOY_X, TRACE_JOY_Y, TRACE_END = 7 };
+const byte TRACE_WAIT_LONG = 31;
+// 記録では割り込みが積んでシリアルへ、再生ではシリアルから積んで割り込みが読む (2 の累乗)
+const byte TRACE_BUFFER_SIZE = 128;
+static volatile byte trace_buffer[TRACE_BUFFER_SIZE];
+static volatile byte trace_head = 0;
+static volatile byte trace_tail = 0;
+// 前の変化点からのティック数
+static unsigned long trace_elapsed = 0;
+// 最後の AD 変換値 (差の基準)
+static word trace_adc[ADC_PINS.size()];
+// 記録で溢れたバイト数、再生でデータが間に合わなかったティック数
+static volatile word trace_lost = 0;
+// 再生で読んだが、まだ時刻が来ていない変化点
+static boolean trace_pending = false;
+static TraceKind trace_kind;
+static unsigned long trace_wait;
+static word trace_value;
+// 再生で読み終えたバイト数 (シリアルで送り手に空きを知らせる)
+static volatile byte trace_consumed = 0;
+// 再生で最初の変化点が届いた (それまでは時刻を進めない)
+static boolean trace_started = false;
+// 再生が最後まで進んだ
+static volatile boolean trace_finished = false;
+
+inline byte traceCount() {
+  return (trace_head - trace_tail) & (TRACE_BUFFER_SIZE - 1);
+}
+
+inline void tracePut(const byte data) {
+  const byte head = trace_head;
+  const byte next = (head + 1) & (TRACE_BUFFER_SIZE - 1);
+  if (next == trace_tail) {
+    if (trace_lost < 0xFFFF) trace_lost++;
+    return;
+  }
+  trace_buffer[head] = data;
+  trace_head = next;
+}
+
+inline void tracePutNumber(unsigned long value) {
+  while (value >= 0x80) {
+    tracePut(value | 0x80);
+    value >>= 7;
+  }
+  tracePut(value);
+}
+
+// 種類と待ち時間を積む
+inline void traceEvent(const TraceKind kind) {
+  const unsigned long wait = trace_elapsed;
+  tracePut(kind << 5 | min(wait, (unsigned long) TRACE_WAIT_LONG));
+  if (wait >= TRACE_WAIT_LONG) tracePutNumber(wait - TRACE_WAIT_LONG);
+  trace_elapsed = 0;
+}
+
+// 変化点を記録 (割り込みから毎ティック)
+inline void traceRecordTick() {
+  const byte level = inputLevel();
+  if (level != trace_level) {
+    traceEvent(TRACE_LEVEL);
+    tracePut(level);
+    trace_level = level;
+  }
+  for (byte i = 0; i < ADC_PINS.size(); i++) {
+    const word value = getAdc((AdcIndex) i);
+    if (value == trace_adc[i]) continue;
+    traceEvent((TraceKind) (TRACE_POT + i));
+    const int delta = value - trace_adc[i];
+    tracePutNumber(delta < 0 ? ~((unsigned) delta << 1) : (unsigned) delta << 1);
+    trace_adc[i] = value;
+  }
+  trace_elapsed++;
+}
+
+// 位置 at から可変長の数を読む (途中で無くなれば false)
+inline boolean traceNumber(byte &at, unsigned long &value) {
+  value = 0;
+  for (byte shift = 0; ; shift += 7) {
+    if (at == trace_head) return false;
+    const byte data = trace_buffer[at];
+    at = (at + 1) & (TRACE_BUFFER_SIZE - 1);
+    value |= (unsigned long) (data & 0x7F) << shift;
+    if (!(data & 0x80)) return true;
+  }
+}
+
+// 次の変化点を丸ごと読めれば取り出す
+inline boolean traceTake() {
+  byte at = trace_tail;
+  if (at == trace_head) return false;
+  const byte first = trace_buffer[at];
+  at = (at + 1) & (TRACE_BUFFER_SIZE - 1);
+  unsigned long wait = first & TRACE_WAIT_LONG;
+  if (wait == TRACE_WAIT_LONG) {
+    unsigned long more;
+    if (!traceNumber(at, more)) return false;
+    wait += more;
+  }
+  const TraceKind kind = (TraceKind) (first >> 5);
+  unsigned long value = 0;
+  if (kind == TRACE_LEVEL) {
+    if (at == trace_head) return false;
+    value = trace_buffer[at];
+    at = (at + 1) & (TRACE_BUFFER_SIZE - 1);
+  } else if (kind != TRACE_END) {
+    unsigned long zigzag;
+    if (!traceNumber(at, zigzag)) return false;
+    value = trace_adc[kind - TRACE_POT] + (word) ((zigzag & 1) ? ~(zigzag >> 1) : zigzag >> 1);
+  }
+  trace_consumed += (at - trace_tail) & (TRACE_BUFFER_SIZE - 1);
+  trace_tail = at;
+  trace_kind = kind;
+  trace_wait = wait;
+  trace_value = value;
+  trace_pending = true;
+  return true;
+}
+
+// 時刻が来た変化点を入力に反映 (割り込みから毎ティック)
+inline void traceReplayTick() {
+  for (;;) {
+    if (!trace_pending && !traceTake()) {
+      if (!trace_started) return;
+      // 送り手が間に合わず、以降の時刻はずれる
+      if (trace_lost < 0xFFFF) trace_lost++;
+      break;
+    }
+    trace_started = true;
+    if (trace_elapsed < trace_wait) break;
+    trace_pending = false;
+    trace_elapsed = 0;
+    if (trace_kind == TRACE_END) {
+      trace_mode = TRACE_OFF;
+      trace_finished = true;
+      return;
+    }
+    if (trace_kind == TRACE_LEVEL) {
+      trace_level = trace_value;
+    } else {
+      const byte index = trace_kind - TRACE_POT;
+      trace_adc[index] = trace_value;
+      adc_filter[index] = trace_value << ADC_FILTER_SHIFT;
+    }
+  }
+  trace_elapsed++;
+}
+
+// 記録・再生を1ティック進める (入力の読み取りより先に呼ぶ)
+inline void traceTick() {
+  if (trace_mode == TRACE_RECORD) traceRecordTick();
+  else if (trace_mode == TRACE_REPLAY) traceReplayTick();
+}
+
+// 記録か再生を始める (記録の最初の変化点で今の状態が全て入る)
+void traceStart(const TraceMode mode) {
+  const byte sreg = SREG;
+  cli();
+  trace_mode = TRACE_OFF;
+  trace_head = 0;
+  trace_tail = 0;
+  trace_elapsed = 0;
+  trace_lost = 0;
+  trace_level = 0;
+  for (byte i = 0; i < ADC_PINS.size(); i++) trace_adc[i] = 0;
+  trace_pending = false;
+  trace_started = false;
+  trace_consumed = 0;
+  trace_finished = false;
+  trace_mode = mode;
+  SREG = sreg;
+}
+
+/*******************
+ * システムタイマー *
+ *******************/
+
+// 10kHz の周期処理 (Timer4。使わない部品の処理はコンパイル時に消える)
+ISR(TIMER4_OVF_vect) {
+  // PWM の周期の頭に合わせるので最初に
+  if (isUsed(MONO_BAR)) barTick();
+  tick_count++;
+  if (isUsed(MONO_BUS)) busTick();
+  if (isUsed(MONO_INPUT | MONO_ADC)) traceTick();
+  if (isUsed(MONO_INPUT)) inputSample();
+  if (isUsed(MONO_DC)) {
+    dcControlTick();
+    dcPwmTick();
+  }
+  if (isUsed(MONO_BUZZER)) buzzTick();
+  if (isUsed(MONO_SERVO)) servoTick();
+}
+
+// Timer4 を高速 PWM (TOP = ICR4)・分周なしで占有 (OC4B, OC4C の出力は LED バーが使う)
+// 時刻とタスクの元なので MONO_PROFILE に関わらず使う
+void tickBegin() {
+  TCCR4A = _BV(WGM41);
+  TCCR4B = _BV(WGM43) | _BV(WGM42) | _BV(CS40);
+  ICR4 = TICK_TOP;
+  TCNT4 = 0;
+  TIMSK4 = _BV(TOIE4);
+}
+
+// Timer1 を標準動作・8分周で回し続ける (比較一致 B は LED マトリックス、C は LED バーの青)
+void compareTimerBegin() {
+  TCCR1A = 0;
+  TCCR1B = _BV(CS11);
+  TCNT1 = 0;
+  TIMSK1 = 0;
+}
+
+/*****************
+ * スケジューラー *
+ *****************/
+
+// 登録できるタスクの数
+const byte TASK_MAX = 8;
+// 遅れの平均の平滑化 (1/8 ずつ追従)
+const byte TASK_FILTER_SHIFT = 3;
+
+typedef void (*TaskFunction)();
+// 周期タスク (時刻と周期はティック単位)
+struct Task {
+  TaskFunction function;
+  unsigned long period;
+  // 起動予定からこの時間内に終わらなければ超過
+  unsigned long deadline;
+  // 大きいほど先に実行
+  byte priority;
+  // 次の起動予定
+  unsigned long release;
+  // 実行回数、期限超過の回数 (周期ごと飛ばした分も含む)
+  unsigned long runs;
+  word overruns;
+  // 起動の遅れ (ジッター) の最大と平均 [ティック、平均は 8 倍]
+  word late_max;
+  word late_average;
+  // 実行時間の最大 [us]
+  word time_max;
+};
+static Task tasks[TASK_MAX];
+static byte task_count = 0;
+// タスクを実行していた時間の合計と、計測を始めた時刻 [us]
+static unsigned long task_busy = 0;
+static unsigned long task_since = 0;
+
+// 周期 period_ms で function を実行するタスクを登録 (deadline_ms が 0 なら周期と同じ。戻り値は番号、一杯なら 255)
+byte taskAdd(const TaskFunction function, const word period_ms, const byte priority = 0, const word deadline_ms = 0) {
+  if (task_count >= TASK_MAX || !function) return 255;
+  Task &task = tasks[task_count];
+  task.function = function;
+  task.period = max((unsigned long) period_ms * (TICK_HZ / 1000), 1UL);
+  task.deadline = deadline_ms ? (unsigned long) deadline_ms * (TICK_HZ / 1000) : task.period;
+  task.priority = priority;
+  task.release = ticks();
+  task.runs = 0;
+  task.overruns = 0;
+  task.late_max = 0;
+  task.late_average = 0;
+  task.time_max = 0;
+  if (!task_count) task_since = micros();
+  return task_count++;
+}
+
+// 起動予定を過ぎたタスクのうち優先度が最も高いものを1つ実行 (無ければ false を返すので、空き時間に他の処理ができる)
+boolean taskRun() {
+  const unsigned long now = ticks();
+  byte next = 255;
+  for (byte i = 0; i < task_count; i++) {
+    const Task &task = tasks[i];
+    if ((long) (now - task.release) < 0) continue;
+    // 同じ優先度なら起動予定の早い方
+    if (next == 255 || task.priority > tasks[next].priority
+        || (task.priority == tasks[next].priority && (long) (task.release - tasks[next].release) < 0)) next = i;
+  }
+  if (next == 255) return false;
+  Task &task = tasks[next];
+  // 平均を 8 倍しても溢れない範囲で
+  const word late = min(now - task.release, 0x1FFFUL);
+  const unsigned long start = micros();
+  // タスク内の出力はまとめて最後に
+  outputBegin();
+  task.function();
+  outputCommit();
+  const unsigned long time = micros() - start;
+  task_busy += time;
+  // 統計
+  task.runs++;
+  task.time_max = max(task.time_max, (word) min(time, 0xFFFFUL));
+  task.late_max = max(task.late_max, late);
+  task.late_average += late - (task.late_average >> TASK_FILTER_SHIFT);
+  const unsigned long end = ticks();
+  boolean overrun = end - task.release > task.deadline;
+  // 周期は起動予定から数える (遅れても積み重ならない)。1周期以上遅れた分は飛ばす
+  task.release += task.period;
+  if ((long) (end - task.release) >= (long) task.period) {
+    overrun = true;
+    task.release = end;
+  }
+  if (overrun) task.overruns++;
+  return true;
+}
+
+// 計測を始めてから、タスクを実行していない時間の割合 [%]
+byte taskIdle() {
+  const unsigned long elapsed = micros() - task_since;
+  if (!elapsed || task_busy >= elapsed) return task_busy ? 0 : 100;
+  return 100 - task_busy * 100.0f / elapsed;
+}
+
+// 統計を消して計測をやり直す
+void taskResetStats() {
+  for (byte i = 0; i < task_count; i++) {
+    Task &task = tasks[i];
+    task.runs = 0;
+    task.overruns = 0;
+    task.late_max = 0;
+    task.late_average = 0;
+    task.time_max = 0;
+  }
+  task_busy = 0;
+  task_since = micros();
+}
+
+// 番号 id のタスク (統計の参照用)
+inline const Task &task(const byte id) {
+  return tasks[id];
+}
+
+// 起動の遅れの平均 [us]
+inline unsigned long taskJitter(const byte id) {
+  return ((unsigned long) tasks[id].late_average * (1000000UL / TICK_HZ)) >> TASK_FILTER_SHIFT;
+}
+
+/***************
+ * テレメトリー *
+ ***************/
+
+// 既定の通信速度 (16MHz の倍速モードで誤差 0%)
+const unsigned long TELEMETRY_BAUD = 1000000;
+// フレームの同期バイトと形式の版
+const byte TELEMETRY_SYNC_1 = 0xA5;
+const byte TELEMETRY_SYNC_2 = 0x5A;
+const byte TELEMETRY_VERSION = 1;
+
+// 1回分の状態 (リトルエンディアンでそのまま送るので幅は固定。tools/telemetry_decode.cpp と揃える)
+struct __attribute__((packed)) TelemetryPayload {
+  uint8_t version;
+  // 送れなかった分も数える (抜けで取りこぼしが分かる)
+  uint16_t sequence;
+  // 起動からのティック数 (100us 単位)
+  uint32_t time;
+  // InputSource のビット (1 が有効側)
+  uint8_t input;
+  uint16_t pot;
+  uint16_t joy_x;
+  uint16_t joy_y;
+  // 7セグとモーターの共有線の値
+  uint8_t seg;
+  uint8_t motor;
+  // 表示中の面 (最上位の階調)
+  uint8_t matrix[8];
+  // 1本ごとの色 (RGB565)
+  uint16_t bar[BAR_COUNT];
+  // サーボのパルス幅 [us]
+  uint16_t servo;
+  uint16_t rpm;
+  int32_t stepper;
+  // TelemetryFlag のビット
+  uint8_t flags;
+};
+enum TelemetryFlag : byte { TM_BUZZING = 1, TM_SERVO_REACHED = 2, TM_DC_SETTLED = 4, TM_BAR_FADING = 8, TM_STEPPER_MOVING = 16 };
+// 同期バイト2つ・長さ・本体・CRC-8 (送信バッファ 63 バイトに1フレームが収まる)
+const byte TELEMETRY_FRAME_SIZE = 3 + sizeof(TelemetryPayload) + 1;
+static_assert(TELEMETRY_FRAME_SIZE <= 63, "telemetry frame must fit the serial TX buffer");
+
+static word telemetry_sequence = 0;
+// 送るタスクの番号 (telemetryBegin() の前は 255)
+static byte telemetry_task = 255;
+// 送信中 (telemetryStream() で止められる)
+static boolean telemetry_on = false;
+// 送信バッファが空かず捨てたフレームの数
+static word telemetry_dropped = 0;
+
+// 現在の状態を1フレームにして送る (空きが無ければ待たずに捨てる)
+void telemetrySend() {
+  if (!telemetry_on) return;
+  // 使わない部品の欄は 0 のまま
+  byte frame[TELEMETRY_FRAME_SIZE] = {};
+  TelemetryPayload &payload = *(TelemetryPayload *) (frame + 3);
+  payload.version = TELEMETRY_VERSION;
+  payload.sequence = telemetry_sequence++;
+  payload.time = ticks();
+  if (isUsed(MONO_INPUT)) payload.input = input_state;
+  if (isUsed(MONO_ADC)) {
+    payload.pot = getPot();
+    payload.joy_x = getJoyX();
+    payload.joy_y = getJoyY();
+  }
+  byte sreg = SREG;
+  cli();
+  if (isUsed(MONO_BUS)) {
+    payload.seg = seg_bus;
+    payload.motor = motor_bus;
+  }
+  if (isUsed(MONO_MATRIX)) memcpy(payload.matrix, (const byte *) matrix_buffer[matrix_front][MATRIX_DEPTH - 1], 8);
+  SREG = sreg;
+  if (isUsed(MONO_BAR)) {
+    for (byte i = 0; i < BAR_COUNT; i++) {
+      sreg = SREG;
+      cli();
+      const BarFade &fade = bar_fade[i];
+      payload.bar[i] = (fade.level[0] & 0xF800) | (fade.level[1] >> 5 & 0x07E0) | fade.level[2] >> 11;
+      SREG = sreg;
+    }
+    if (isBarFading()) payload.flags |= TM_BAR_FADING;
+  }
+  if (isUsed(MONO_SERVO)) {
+    payload.servo = servo_written;
+    if (isServoReached()) payload.flags |= TM_SERVO_REACHED;
+  }
+  if (isUsed(MONO_INPUT)) payload.rpm = tachRpm();
+  if (isUsed(MONO_DC) && isDcSettled()) payload.flags |= TM_DC_SETTLED;
+  if (isUsed(MONO_STEPPER)) {
+    payload.stepper = stepperPosition();
+    if (isStepperMoving()) payload.flags |= TM_STEPPER_MOVING;
+  }
+  if (isUsed(MONO_BUZZER) && isBuzzing()) payload.flags |= TM_BUZZING;
+  frame[0] = TELEMETRY_SYNC_1;
+  frame[1] = TELEMETRY_SYNC_2;
+  frame[2] = sizeof(TelemetryPayload);
+  // 長さから本体の終わりまで
+  byte crc = 0;
+  for (byte i = 2; i < TELEMETRY_FRAME_SIZE - 1; i++) crc = _crc8_ccitt_update(crc, frame[i]);
+  frame[TELEMETRY_FRAME_SIZE - 1] = crc;
+  // 送信は USART の割り込みがバッファから抜くので、空きがあれば書き込みは待たない
+  if (Serial.availableForWrite() < TELEMETRY_FRAME_SIZE) {
+    telemetry_dropped++;
+    return;
+  }
+  Serial.write(frame, TELEMETRY_FRAME_SIZE);
+}
+
+// シリアルを baud で開き直し、period_ms 毎に状態を送るタスクを登録 (戻り値はタスクの番号)
+byte telemetryBegin(const word period_ms = 10, const unsigned long baud = TELEMETRY_BAUD) {
+  Serial.end();
+  Serial.begin(baud);
+  telemetry_sequence = 0;
+  telemetry_dropped = 0;
+  telemetry_on = true;
+  telemetry_task = taskAdd(telemetrySend, period_ms);
+  return telemetry_task;
+}
+
+// 送信を止める・再開する (止めている間は番号も進まない。telemetryBegin() の前なら false)
+inline boolean telemetryStream(const boolean on) {
+  if (telemetry_task == 255) return false;
+  telemetry_on = on;
+  return true;
+}
+
+// 捨てたフレームの数
+inline word telemetryDropped() {
+  return telemetry_dropped;
+}
+
+/***********
+ * 自己診断 *
+ ***********/
+
+// 診断の項目 (同時に進める)
+enum TestStage : byte { TEST_ADC, TEST_INPUT, TEST_DC, TEST_STEPPER, TEST_SERVO, TEST_MATRIX, TEST_BAR, TEST_SEG, TEST_BUZZ, TEST_COUNT };
+namespace flash { const char TEST_NAMES[] PROGMEM = "adc\0input\0dc\0stepper\0servo\0matrix\0bar\0seg\0buzz\0"; }
+// 結果 (TEST_SKIP は人の操作が要る項目を飛ばした時)
+enum TestResult : byte { TEST_WAIT, TEST_RUN, TEST_PASS, TEST_FAIL, TEST_SKIP };
+namespace flash { const char TEST_RESULTS[] PROGMEM = "wait\0run\0pass\0fail\0skip\0"; }
+// 項目ごとの開始時刻 [ms] と制限時間 [ms] (モーターの雑音が入らないように AD 変換を先に済ませる)
+namespace flash {
+  const word TEST_START[] PROGMEM = { 0, 0, 300, 300, 300, 300, 300, 300, 300 };
+  const word TEST_LIMIT[] PROGMEM = { 300, 10000, 3000, 5000, 3000, 2000, 2000, 2000, 3000 };
+  // 項目が使う部品 (MONO_PROFILE に無ければ skip)
+  const word TEST_PARTS[] PROGMEM = { MONO_ADC, MONO_INPUT, MONO_DC | MONO_INPUT, MONO_STEPPER, MONO_SERVO, MONO_MATRIX, MONO_BAR, MONO_SEG, MONO_BUZZER };
+}
+constexpr auto TEST_START = flashTable(flash::TEST_START);
+constexpr auto TEST_LIMIT = flashTable(flash::TEST_LIMIT);
+constexpr auto TEST_PARTS = flashTable(flash::TEST_PARTS);
+// 静止中の AD 変換値の揺れの許容 [LSB]
+const word TEST_ADC_NOISE = 24;
+// DC モーターを回してフォトインタラプタが遮られるべき回数
+const byte TEST_TACH_PULSES = 8;
+// ステッピングモーターを往復させる歩数
+const byte TEST_STEPPER_STEPS = 48;
+// 全タクトのビット (InputSource)
+const byte TEST_TACT_BITS = _BV(IN_TL) | _BV(IN_TR) | _BV(IN_LL) | _BV(IN_LR) | _BV(IN_RL) | _BV(IN_RR);
+
+// 項目ごとの開始時刻・かかった時間 [ms]、測った値と途中の段階
+struct TestReport { TestResult result; word start; word time; long value; byte phase; };
+static TestReport test_reports[TEST_COUNT];
+// AD 変換値の最小・最大
+static word test_adc_min[ADC_PINS.size()];
+static word test_adc_max[ADC_PINS.size()];
+// 診断を始めた時の遮られた回数とステッピングモーターの位置
+static unsigned long test_tach_from = 0;
+static long test_stepper_from = 0;
+
+// 遮られた回数 (割り込みで更新される)
+inline unsigned long testTachCount() {
+  const byte sreg = SREG;
+  cli();
+  const unsigned long count = tach_count;
+  SREG = sreg;
+  return count;
+}
+
+// 項目を1回進める (elapsed は開始からの時間 [ms]。終わるまで TEST_RUN を返す。使わない部品の項目は TEST_SKIP)
+TestResult testStep(const TestStage stage, TestReport &report, const word elapsed) {
+  switch (stage) {
+    case TEST_ADC:
+      if (!isUsed(MONO_ADC)) break;
+      // 静止中に揺れが小さく、ジョイスティックが中央にあるか
+      for (byte i = 0; i < ADC_PINS.size(); i++) {
+        const word value = getAdc((AdcIndex) i);
+        if (!report.phase || value < test_adc_min[i]) test_adc_min[i] = value;
+        if (!report.phase || value > test_adc_max[i]) test_adc_max[i] = value;
+      }
+      report.phase = 1;
+      report.value = getPot();
+      if (elapsed < TEST_LIMIT[TEST_ADC]) return TEST_RUN;
+      for (byte i = 0; i < ADC_PINS.size(); i++) if (test_adc_max[i] - test_adc_min[i] > TEST_ADC_NOISE) return TEST_FAIL;
+      if (getJoyX() < THRESHOLD_LOW || getJoyX() > THRESHOLD_HIGH || getJoyY() < THRESHOLD_LOW || getJoyY() > THRESHOLD_HIGH) return TEST_FAIL;
+      return TEST_PASS;
+    case TEST_INPUT:
+      if (!isUsed(MONO_INPUT)) break;
+      // 全部離されてから、各タクトが1回ずつ押されるのを待つ (値は押されたタクトのビット)
+      if (!report.phase) {
+        if (input_state & TEST_TACT_BITS) return TEST_RUN;
+        for (byte i = 0; i < 6; i++) while (inputTake((InputSource) i));
+        report.value = 0;
+        report.phase = 1;
+      }
+      for (byte i = 0; i < 6; i++) if (inputTake((InputSource) i)) report.value |= _BV(i);
+      return report.value == TEST_TACT_BITS ? TEST_PASS : TEST_RUN;
+    case TEST_DC:
+      if (!isUsed(MONO_DC) || !isUsed(MONO_INPUT)) break;
+      // 回した羽がフォトインタラプタを遮るか (値は回転数 [rpm])
+      if (!report.phase) {
+        test_tach_from = testTachCount();
+        dc(RT);
+        report.phase = 1;
+      }
+      report.value = tachRpm();
+      return testTachCount() - test_tach_from >= TEST_TACH_PULSES ? TEST_PASS : TEST_RUN;
+    case TEST_STEPPER:
+      if (!isUsed(MONO_STEPPER)) break;
+      // 往復して元の位置に戻るか (値は進んだ歩数)
+      if (!report.phase) {
+        test_stepper_from = stepperPosition();
+        stepperMoveTo(test_stepper_from + TEST_STEPPER_STEPS);
+        report.phase = 1;
+      } else if (!isStepperMoving()) {
+        report.value = max(report.value, labs(stepperPosition() - test_stepper_from));
+        if (report.phase == 2) return stepperPosition() == test_stepper_from ? TEST_PASS : TEST_FAIL;
+        stepperMoveTo(test_stepper_from);
+        report.phase = 2;
+      }
+      return TEST_RUN;
+    case TEST_SERVO:
+      if (!isUsed(MONO_SERVO)) break;
+      // 端から端まで動かす (値は最後のパルス幅 [us])
+      if (!report.phase) {
+        servo(SERVO_MAX);
+        report.phase = 1;
+      } else if (isServoReached()) {
+        report.value = servo_written;
+        if (report.phase == 2) return TEST_PASS;
+        servo(SERVO_MIN);
+        report.phase = 2;
+      }
+      return TEST_RUN;
+    case TEST_MATRIX:
+      if (!isUsed(MONO_MATRIX)) break;
+      // 階調の斜めの模様、全点灯の順に出し、割り込みが面を入れ替えるか (値は入れ替わった回数)
+      if (matrix_swap) return TEST_RUN;
+      report.value = report.phase;
+      if (report.phase == 0) {
+        for (byte y = 0; y < 8; y++) for (byte x = 0; x < 8; x++) matrixPixel(x, y, x + y);
+      } else if (report.phase == 1) {
+        if (elapsed < 600) return TEST_RUN;
+        matrixGrayFill(MATRIX_LEVEL_MAX);
+      } else {
+        return elapsed >= 1000 ? TEST_PASS : TEST_RUN;
+      }
+      matrixGrayShow();
+      report.phase++;
+      return TEST_RUN;
+    case TEST_BAR:
+      if (!isUsed(MONO_BAR)) break;
+      // 赤から青へのグラデーションのフェードが割り込みで終わるか
+      if (!report.phase) {
+        barGradient(rgb(0xFF0000), rgb(0x0000FF), 1000);
+        report.phase = 1;
+      }
+      return isBarFading() ? TEST_RUN : TEST_PASS;
+    case TEST_SEG:
+      if (!isUsed(MONO_SEG)) break;
+      // 0〜9 を 100ms ずつ (目視。値は表示した数字の数)
+      if (elapsed / 100 >= 10) return TEST_PASS;
+      if (report.value <= elapsed / 100) seg(num[report.value++]);
+      return TEST_RUN;
+    case TEST_BUZZ:
+      if (!isUsed(MONO_BUZZER)) break;
+      // 効果音が割り込みで最後まで鳴るか
+      if (!report.phase) {
+        buzzPlay(sfx::ARPEGGIO);
+        report.phase = 1;
+      }
+      return isBuzzing() ? TEST_RUN : TEST_PASS;
+    default:
+      return TEST_FAIL;
+  }
+  // 使わない部品の処理はコンパイル時に消える
+  return TEST_SKIP;
+}
+
+// 項目の後片付け (動かした物を止める)
+void testFinish(const TestStage stage) {
+  switch (stage) {
+    case TEST_DC: if (isUsed(MONO_DC)) dc(S); break;
+    case TEST_STEPPER: if (isUsed(MONO_STEPPER)) stepperStop(); break;
+    case TEST_MATRIX: if (isUsed(MONO_MATRIX)) matrix(mt::ALL_0); break;
+    case TEST_BAR: if (isUsed(MONO_BAR)) bar(); break;
+    case TEST_SEG: if (isUsed(MONO_SEG)) seg(); break;
+    case TEST_BUZZ: if (isUsed(MONO_BUZZER)) buzzStop(); break;
+    default: break;
+  }
+}
+
+// 大会基盤の左右のタクトが同時に押されている間 true
+inline boolean isSelfTestRequested() {
+  return (input_state & (_BV(IN_TL) | _BV(IN_TR))) == (_BV(IN_TL) | _BV(IN_TR));
+}
+
+// 全項目を同時に進めて結果を CSV で out に出す (終わるまで戻らない。全て合格なら true)
+// automatic が true なら人の操作が要る項目 (タクト) は飛ばす
+boolean selfTest(Stream &out = Serial, const boolean automatic = false) {
+  byte done = 0;
+  for (byte i = 0; i < TEST_COUNT; i++) {
+    // 使わない部品の項目も飛ばす
+    const boolean skip = (TEST_PARTS[i] & ~PROFILE) || (automatic && i == TEST_INPUT);
+    test_reports[i] = TestReport { skip ? TEST_SKIP : TEST_WAIT, 0, 0, 0, 0 };
+    if (skip) done++;
+  }
+  out.println(F("selftest,begin"));
+  const unsigned long begin = millis();
+  while (done < TEST_COUNT) {
+    const word now = millis() - begin;
+    for (byte i = 0; i < TEST_COUNT; i++) {
+      TestReport &report = test_reports[i];
+      if (report.result == TEST_WAIT && now >= TEST_START[i]) {
+        report.result = TEST_RUN;
+        report.start = now;
+      }
+      if (report.result != TEST_RUN) continue;
+      const word elapsed = now - report.start;
+      report.result = testStep((TestStage) i, report, elapsed);
+      if (report.result == TEST_RUN && elapsed >= TEST_LIMIT[i]) report.result = TEST_FAIL;
+      if (report.result == TEST_RUN) continue;
+      report.time = elapsed;
+      testFinish((TestStage) i);
+      done++;
+    }
+  }
+  // 項目ごとの結果
+  boolean passed = true;
+  out.println(F("stage,result,start_ms,time_ms,value"));
+  const char *name = flash::TEST_NAMES;
+  for (byte i = 0; i < TEST_COUNT; i++) {
+    const TestReport &report = test_reports[i];
+    const char *result = flash::TEST_RESULTS;
+    for (byte r = 0; r < report.result; r++) result += strlen_P(result) + 1;
+    out.print((const __FlashStringHelper *) name);
+    name += strlen_P(name) + 1;
+    out.print(',');
+    out.print((const __FlashStringHelper *) result);
+    out.print(',');
+    out.print(report.start);
+    out.print(',');
+    out.print(report.time);
+    out.print(',');
+    out.println(report.value);
+    if (report.result == TEST_FAIL) passed = false;
+  }
+  out.print(passed ? F("selftest,pass,") : F("selftest,fail,"));
+  out.println(millis() - begin);
+  if (isUsed(MONO_BUZZER)) buzzPlay(passed ? sfx::OK : sfx::NG);
+  // 止めていた間のタスクは遅れに数えない
+  const unsigned long now = ticks();
+  for (byte i = 0; i < task_count; i++) tasks[i].release = now;
+  return passed;
+}
+
+/*************
+ * コマンド *
+ *************/
+
+// 1行の最大の長さ
+const byte COMMAND_LENGTH = 24;
+// 手順の版 (hello の応答に入れる)
+const byte COMMAND_VERSION = 1;
+static char command_line[COMMAND_LENGTH + 1];
+static byte command_length = 0;
+// 長すぎて捨てている行
+static boolean command_overflow = false;
+
+// 記録のフレームの同期バイト (2つ目はテレメトリーと区別する)
+const byte TRACE_SYNC_2 = 0x5B;
+// 記録を送る1フレームの最大の長さ
+const byte TRACE_FRAME_DATA = 48;
+// 再生で空きを知らせる単位
+const byte TRACE_CREDIT = 32;
+
+// 記録した変化点を同期バイト・長さ・データ・CRC-8 のフレームで送る (送信バッファが空くまで待たない)
+void traceSend(Stream &io, const boolean all = false) {
+  for (;;) {
+    const byte count = min(traceCount(), TRACE_FRAME_DATA);
+    if (!count || (!all && io.availableForWrite() < count + 4)) return;
+    byte frame[TRACE_FRAME_DATA + 4];
+    frame[0] = TELEMETRY_SYNC_1;
+    frame[1] = TRACE_SYNC_2;
+    frame[2] = count;
+    byte crc = _crc8_ccitt_update(0, count);
+    byte tail = trace_tail;
+    for (byte i = 0; i < count; i++) {
+      frame[3 + i] = trace_buffer[tail];
+      crc = _crc8_ccitt_update(crc, frame[3 + i]);
+      tail = (tail + 1) & (TRACE_BUFFER_SIZE - 1);
+    }
+    trace_tail = tail;
+    frame[3 + count] = crc;
+    io.write(frame, count + 4);
+  }
+}
+
+// 記録を送り、再生では受信したデータを積んで空きを知らせる (commandService() から呼ばれる)
+void traceService(Stream &io) {
+  if (trace_mode == TRACE_RECORD) {
+    traceSend(io);
+  } else if (trace_mode == TRACE_REPLAY) {
+    while (io.available() && traceCount() < TRACE_BUFFER_SIZE - 1) {
+      trace_buffer[trace_head] = io.read();
+      trace_head = (trace_head + 1) & (TRACE_BUFFER_SIZE - 1);
+    }
+  }
+  if (trace_consumed >= TRACE_CREDIT) {
+    const byte sreg = SREG;
+    cli();
+    const byte consumed = trace_consumed;
+    trace_consumed = 0;
+    SREG = sreg;
+    io.print(F("trace,credit,"));
+    io.println(consumed);
+  }
+  if (trace_finished) {
+    trace_finished = false;
+    io.print(F("trace,end,"));
+    io.println(trace_lost);
+  }
+}
+
+// 1行を実行し、最後に "ok,名前" か "error,名前" を返す
+void commandRun(const char *line, Stream &io) {
+  const char *arg = strchr(line, ' ');
+  const byte length = arg ? arg - line : strlen(line);
+  if (arg) while (*arg == ' ') arg++;
+  // 記録と再生は入力を使う時だけ
+  const boolean trace = isUsed(MONO_INPUT | MONO_ADC) && length == 5 && !strncmp_P(line, PSTR("trace"), 5) && arg;
+  boolean ok = true;
+  if (length == 5 && !strncmp_P(line, PSTR("hello"), 5)) {
+    io.print(F("hello,mono2025,"));
+    io.println(COMMAND_VERSION);
+  } else if ((length == 4 && !strncmp_P(line, PSTR("test"), 4)) || (length == 1 && line[0] == 't')) {
+    // "test auto" は人の操作が要る項目を飛ばす
+    selfTest(io, arg && !strcmp_P(arg, PSTR("auto")));
+  } else if ((length == 5 && !strncmp_P(line, PSTR("probe"), 5)) || (length == 1 && line[0] == 'p')) {
+#ifdef MONO_PROBES
+    probeDump(io);
+#else
+    ok = false;
+#endif
+  } else if ((length == 5 && !strncmp_P(line, PSTR("reset"), 5)) || (length == 1 && line[0] == 'r')) {
+    probeReset();
+    taskResetStats();
+  } else if (length == 9 && !strncmp_P(line, PSTR("telemetry"), 9) && arg && (!strcmp_P(arg, PSTR("on")) || !strcmp_P(arg, PSTR("off")))) {
+    ok = telemetryStream(arg[1] == 'n');
+  } else if (length == 6 && !strncmp_P(line, PSTR("stream"), 6) && arg && (*arg == '0' || *arg == '1')) {
+    ok = telemetryStream(*arg == '1');
+  } else if (trace && !strcmp_P(arg, PSTR("record"))) {
+    traceStart(TRACE_RECORD);
+  } else if (trace && !strcmp_P(arg, PSTR("replay"))) {
+    // 以降の受信は変化点のデータ (TRACE_END まで)
+    traceStart(TRACE_REPLAY);
+    io.print(F("trace,credit,"));
+    io.println(TRACE_BUFFER_SIZE - 1);
+  } else if (trace && !strcmp_P(arg, PSTR("stop"))) {
+    // 記録の残りを全て送ってから
+    if (trace_mode == TRACE_RECORD) {
+      trace_mode = TRACE_OFF;
+      traceSend(io, true);
+    }
+    trace_mode = TRACE_OFF;
+    io.print(F("trace,lost,"));
+    io.println(trace_lost);
+  } else {
+    ok = false;
+  }
+  io.print(ok ? F("ok,") : F("error,"));
+  io.write((const byte *) line, length);
+  io.println();
+}
+
+// 受信した文字を行にまとめ、改行が来たら実行 (loop() から呼ぶ。待たない)
+void commandService(Stream &io = Serial) {
+  if (isUsed(MONO_INPUT | MONO_ADC)) {
+    traceService(io);
+    // 再生中の受信は全て変化点のデータ
+    if (trace_mode == TRACE_REPLAY) return;
+  }
+  while (io.available()) {
+    const char c = io.read();
+    if (c != '\n' && c != '\r') {
+      if (command_length < COMMAND_LENGTH) command_line[command_length++] = c;
+      else command_overflow = true;
+      continue;
+    }
+    if (command_length && !command_overflow) {
+      command_line[command_length] = '\0';
+      commandRun(command_line, io);
+    }
+    command_length = 0;
+    command_overflow = false;
+  }
+}
+
 /***********
  * 実行準備 *
  ***********/
@@ -594,16 +3601,39 @@ void start(void);
 void setup() {
   // ボードレートを指定
   Serial.begin(9600);
-  // 出力ピンの割り当て
-  for (byte i = 0; i < ARRAY_SIZE(PIN_WRITE); i++) pinMode(PIN_WRITE[i], OUTPUT);
+  // 使う部品の出力ピンの割り当て
+  if (isUsed(MONO_BAR)) pinsMode(PIN_BAR, OUTPUT);
+  if (isUsed(MONO_BUZZER)) pinsMode(PIN_BUZZER, OUTPUT);
+  if (isUsed(MONO_BUS)) pinsMode(PIN_BUS, OUTPUT);
+  if (isUsed(MONO_MATRIX)) pinsMode(PIN_MATRIX, OUTPUT);
   // 入力ピンの割り当て
-  for (byte i = 0; i < ARRAY_SIZE(PIN_READ); i++) pinMode(PIN_READ[i], INPUT);
-  // サーボの初期化
+  if (isUsed(MONO_INPUT)) pinsMode(PIN_SWITCH, INPUT);
+  if (isUsed(MONO_ADC)) pinsMode(ADC_PINS, INPUT);
+#if MONO_PROFILE & MONO_SERVO
+  // サーボの初期化 (台形の速度で動かす)
   srv.attach(SERVO_PIN);
+  servoTune(240, 1200);
+#endif // MONO_SERVO
+  // ステッピングモーターのタイマー
+  if (isUsed(MONO_STEPPER)) stepperBegin();
   // DCモーターを停止
-  dc(S);
-  // LEDマトリックスを非表示
-  matrix_reset();
+  if (isUsed(MONO_DC)) dc(S);
+  // スイッチ・フォトインタラプタの監視開始 (ティックより先に状態を決める)
+  if (isUsed(MONO_INPUT)) inputBegin();
+  // LED マトリックスの走査と LED バーの青の PWM のタイマー
+  if (isUsed(MONO_MATRIX | MONO_BAR)) compareTimerBegin();
+  // システムタイマー・共有線の切り替え開始 (どの構成でも使う)
+  tickBegin();
+  // 可変抵抗器とジョイスティックの読み取り開始
+  if (isUsed(MONO_ADC)) adcBegin();
+  if (isUsed(MONO_MATRIX)) {
+    // LEDマトリックスを非表示
+    matrix_reset();
+    RCLK_PIN.low();
+    matrixWrite(0);
+    // LEDマトリックスの走査開始
+    matrixBegin();
+  }
   // オプション関数
   start();
 }
@@ -0,0 +1,35 @@
+# benchmark_sim をシナリオ (入力スクリプト) 毎に動かし、結果を1つの CSV にまとめる
+#   cmake -DSIM=benchmark_sim -DSCENARIOS=Benchmark/scenarios -DOUT=benchmark.csv -P benchmark.cmake
+# 仮想ボードのクロック数はレジスタの読み書きと Arduino の関数の見積もりだけ (計算の分は入らない) なので、
+# 列名を io_cycles_* にする。実行毎に同じ値になるので、版の間で比べれば入出力が増えた所が分かる
+
+file(GLOB scenarios "${SCENARIOS}/*.txt")
+list(SORT scenarios)
+set(csv "scenario,name,calls,io_cycles_min,io_cycles_mean,io_cycles_max\n")
+foreach(script ${scenarios})
+  get_filename_component(scenario ${script} NAME_WE)
+  execute_process(
+    COMMAND ${SIM} --seconds 3 --script ${script} --serial-out - --quiet
+    OUTPUT_VARIABLE out
+    RESULT_VARIABLE result
+  )
+  if(result)
+    message(FATAL_ERROR "${scenario}: ${SIM} failed (${result})")
+  endif()
+  # 結果の行 (名前,数字...) だけに場面の名前を付ける
+  string(REPLACE "\r" "" out "${out}")
+  string(REPLACE "\n" ";" lines "${out}")
+  set(finished OFF)
+  foreach(line ${lines})
+    if(line MATCHES "^benchmark,end,")
+      set(finished ON)
+    elseif(line MATCHES "^[A-Za-z_]+,[0-9]")
+      string(APPEND csv "${scenario},${line}\n")
+    endif()
+  endforeach()
+  if(NOT finished)
+    message(FATAL_ERROR "${scenario}: benchmark did not finish")
+  endif()
+endforeach()
+file(WRITE ${OUT} "${csv}")
+message(STATUS "Wrote ${OUT}")
@@ -0,0 +1,48 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 仮想 ATmega2560 用の Servo ライブラリ
+// 実機と同じく Timer5 を占有したものとして扱い、パルス幅を仮想ボードへ渡す。
+
+#ifndef Servo_h
+#define Servo_h
+
+#include <stdint.h>
+
+#define MIN_PULSE_WIDTH 544
+#define MAX_PULSE_WIDTH 2400
+#define DEFAULT_PULSE_WIDTH 1500
+#define REFRESH_INTERVAL 20000
+#define MAX_SERVOS 48
+#define INVALID_SERVO 255
+
+class Servo {
+ public:
+  Servo();
+  uint8_t attach(int pin);
+  uint8_t attach(int pin, int min, int max);
+  void detach();
+  void write(int value);
+  void writeMicroseconds(int value);
+  int read();
+  int readMicroseconds();
+  bool attached();
+
+ private:
+  uint8_t servoIndex;
+  int8_t min;
+  int8_t max;
+};
+
+#endif // Servo_h
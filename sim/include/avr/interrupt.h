@@ -0,0 +1,42 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 仮想 ATmega2560 の <avr/interrupt.h>
+// ISR は __vector_N という C リンケージの関数になり、仮想ボードが呼び出す。
+
+#ifndef SIM_AVR_INTERRUPT_H
+#define SIM_AVR_INTERRUPT_H
+
+#include "avr/io.h"
+
+namespace sim {
+void cli();
+void sei();
+} // namespace sim
+
+#define cli() ::sim::cli()
+#define sei() ::sim::sei()
+
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define ISR_FLATTEN
+#define ISR_NOICF
+#define ISR_ALIASOF(v)
+
+#define ISR(vector, ...) extern "C" void vector(void); extern "C" void vector(void)
+#define EMPTY_INTERRUPT(vector) extern "C" void vector(void); extern "C" void vector(void) {}
+#define reti() return
+
+#endif // SIM_AVR_INTERRUPT_H
@@ -0,0 +1,897 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 仮想 ATmega2560 の <avr/io.h>
+// レジスタ名は sim::Reg8 / sim::Reg16 のオブジェクトとして宣言する。
+
+#ifndef SIM_AVR_IO_H
+#define SIM_AVR_IO_H
+
+#include <stdint.h>
+#include "sim/reg.h"
+
+#define __AVR_ATmega2560__ 1
+
+#ifndef _BV
+#define _BV(bit) (1 << (bit))
+#endif
+#define bit_is_set(sfr, bit) ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit) (!((sfr) & _BV(bit)))
+#define loop_until_bit_is_set(sfr, bit) do { } while (bit_is_clear(sfr, bit))
+#define loop_until_bit_is_clear(sfr, bit) do { } while (bit_is_set(sfr, bit))
+
+// レジスタ
+extern sim::Reg8 PINA;
+extern sim::Reg8 DDRA;
+extern sim::Reg8 PORTA;
+extern sim::Reg8 PINB;
+extern sim::Reg8 DDRB;
+extern sim::Reg8 PORTB;
+extern sim::Reg8 PINC;
+extern sim::Reg8 DDRC;
+extern sim::Reg8 PORTC;
+extern sim::Reg8 PIND;
+extern sim::Reg8 DDRD;
+extern sim::Reg8 PORTD;
+extern sim::Reg8 PINE;
+extern sim::Reg8 DDRE;
+extern sim::Reg8 PORTE;
+extern sim::Reg8 PINF;
+extern sim::Reg8 DDRF;
+extern sim::Reg8 PORTF;
+extern sim::Reg8 PING;
+extern sim::Reg8 DDRG;
+extern sim::Reg8 PORTG;
+extern sim::Reg8 PINH;
+extern sim::Reg8 DDRH;
+extern sim::Reg8 PORTH;
+extern sim::Reg8 PINJ;
+extern sim::Reg8 DDRJ;
+extern sim::Reg8 PORTJ;
+extern sim::Reg8 PINK;
+extern sim::Reg8 DDRK;
+extern sim::Reg8 PORTK;
+extern sim::Reg8 PINL;
+extern sim::Reg8 DDRL;
+extern sim::Reg8 PORTL;
+extern sim::Reg8 SREG;
+extern sim::Reg8 GPIOR0;
+extern sim::Reg8 GPIOR1;
+extern sim::Reg8 GPIOR2;
+extern sim::Reg8 TCCR0A;
+extern sim::Reg8 TCCR0B;
+extern sim::Reg8 TCNT0;
+extern sim::Reg8 OCR0A;
+extern sim::Reg8 OCR0B;
+extern sim::Reg8 TIMSK0;
+extern sim::Reg8 TIFR0;
+extern sim::Reg8 TCCR2A;
+extern sim::Reg8 TCCR2B;
+extern sim::Reg8 TCNT2;
+extern sim::Reg8 OCR2A;
+extern sim::Reg8 OCR2B;
+extern sim::Reg8 TIMSK2;
+extern sim::Reg8 TIFR2;
+extern sim::Reg8 ASSR;
+extern sim::Reg8 TCCR1A;
+extern sim::Reg8 TCCR1B;
+extern sim::Reg8 TCCR1C;
+extern sim::Reg8 TIMSK1;
+extern sim::Reg8 TIFR1;
+extern sim::Reg8 TCCR3A;
+extern sim::Reg8 TCCR3B;
+extern sim::Reg8 TCCR3C;
+extern sim::Reg8 TIMSK3;
+extern sim::Reg8 TIFR3;
+extern sim::Reg8 TCCR4A;
+extern sim::Reg8 TCCR4B;
+extern sim::Reg8 TCCR4C;
+extern sim::Reg8 TIMSK4;
+extern sim::Reg8 TIFR4;
+extern sim::Reg8 TCCR5A;
+extern sim::Reg8 TCCR5B;
+extern sim::Reg8 TCCR5C;
+extern sim::Reg8 TIMSK5;
+extern sim::Reg8 TIFR5;
+extern sim::Reg8 ADMUX;
+extern sim::Reg8 ADCSRA;
+extern sim::Reg8 ADCSRB;
+extern sim::Reg8 ADCL;
+extern sim::Reg8 ADCH;
+extern sim::Reg8 DIDR0;
+extern sim::Reg8 DIDR2;
+extern sim::Reg8 PCICR;
+extern sim::Reg8 PCIFR;
+extern sim::Reg8 PCMSK0;
+extern sim::Reg8 PCMSK1;
+extern sim::Reg8 PCMSK2;
+extern sim::Reg8 EICRA;
+extern sim::Reg8 EICRB;
+extern sim::Reg8 EIMSK;
+extern sim::Reg8 EIFR;
+extern sim::Reg8 UCSR0A;
+extern sim::Reg8 UCSR0B;
+extern sim::Reg8 UCSR0C;
+extern sim::Reg8 UDR0;
+extern sim::Reg8 PRR0;
+extern sim::Reg8 PRR1;
+extern sim::Reg8 SMCR;
+extern sim::Reg8 MCUSR;
+extern sim::Reg16 TCNT1;
+extern sim::Reg16 OCR1A;
+extern sim::Reg16 OCR1B;
+extern sim::Reg16 OCR1C;
+extern sim::Reg16 ICR1;
+extern sim::Reg16 TCNT3;
+extern sim::Reg16 OCR3A;
+extern sim::Reg16 OCR3B;
+extern sim::Reg16 OCR3C;
+extern sim::Reg16 ICR3;
+extern sim::Reg16 TCNT4;
+extern sim::Reg16 OCR4A;
+extern sim::Reg16 OCR4B;
+extern sim::Reg16 OCR4C;
+extern sim::Reg16 ICR4;
+extern sim::Reg16 TCNT5;
+extern sim::Reg16 OCR5A;
+extern sim::Reg16 OCR5B;
+extern sim::Reg16 OCR5C;
+extern sim::Reg16 ICR5;
+extern sim::Reg16 ADCW;
+extern sim::Reg16 UBRR0;
+#define ADC ADCW
+
+// ポートのビット
+#define PA0 0
+#define PORTA0 0
+#define DDA0 0
+#define PINA0 0
+#define PA1 1
+#define PORTA1 1
+#define DDA1 1
+#define PINA1 1
+#define PA2 2
+#define PORTA2 2
+#define DDA2 2
+#define PINA2 2
+#define PA3 3
+#define PORTA3 3
+#define DDA3 3
+#define PINA3 3
+#define PA4 4
+#define PORTA4 4
+#define DDA4 4
+#define PINA4 4
+#define PA5 5
+#define PORTA5 5
+#define DDA5 5
+#define PINA5 5
+#define PA6 6
+#define PORTA6 6
+#define DDA6 6
+#define PINA6 6
+#define PA7 7
+#define PORTA7 7
+#define DDA7 7
+#define PINA7 7
+#define PB0 0
+#define PORTB0 0
+#define DDB0 0
+#define PINB0 0
+#define PB1 1
+#define PORTB1 1
+#define DDB1 1
+#define PINB1 1
+#define PB2 2
+#define PORTB2 2
+#define DDB2 2
+#define PINB2 2
+#define PB3 3
+#define PORTB3 3
+#define DDB3 3
+#define PINB3 3
+#define PB4 4
+#define PORTB4 4
+#define DDB4 4
+#define PINB4 4
+#define PB5 5
+#define PORTB5 5
+#define DDB5 5
+#define PINB5 5
+#define PB6 6
+#define PORTB6 6
+#define DDB6 6
+#define PINB6 6
+#define PB7 7
+#define PORTB7 7
+#define DDB7 7
+#define PINB7 7
+#define PC0 0
+#define PORTC0 0
+#define DDC0 0
+#define PINC0 0
+#define PC1 1
+#define PORTC1 1
+#define DDC1 1
+#define PINC1 1
+#define PC2 2
+#define PORTC2 2
+#define DDC2 2
+#define PINC2 2
+#define PC3 3
+#define PORTC3 3
+#define DDC3 3
+#define PINC3 3
+#define PC4 4
+#define PORTC4 4
+#define DDC4 4
+#define PINC4 4
+#define PC5 5
+#define PORTC5 5
+#define DDC5 5
+#define PINC5 5
+#define PC6 6
+#define PORTC6 6
+#define DDC6 6
+#define PINC6 6
+#define PC7 7
+#define PORTC7 7
+#define DDC7 7
+#define PINC7 7
+#define PD0 0
+#define PORTD0 0
+#define DDD0 0
+#define PIND0 0
+#define PD1 1
+#define PORTD1 1
+#define DDD1 1
+#define PIND1 1
+#define PD2 2
+#define PORTD2 2
+#define DDD2 2
+#define PIND2 2
+#define PD3 3
+#define PORTD3 3
+#define DDD3 3
+#define PIND3 3
+#define PD4 4
+#define PORTD4 4
+#define DDD4 4
+#define PIND4 4
+#define PD5 5
+#define PORTD5 5
+#define DDD5 5
+#define PIND5 5
+#define PD6 6
+#define PORTD6 6
+#define DDD6 6
+#define PIND6 6
+#define PD7 7
+#define PORTD7 7
+#define DDD7 7
+#define PIND7 7
+#define PE0 0
+#define PORTE0 0
+#define DDE0 0
+#define PINE0 0
+#define PE1 1
+#define PORTE1 1
+#define DDE1 1
+#define PINE1 1
+#define PE2 2
+#define PORTE2 2
+#define DDE2 2
+#define PINE2 2
+#define PE3 3
+#define PORTE3 3
+#define DDE3 3
+#define PINE3 3
+#define PE4 4
+#define PORTE4 4
+#define DDE4 4
+#define PINE4 4
+#define PE5 5
+#define PORTE5 5
+#define DDE5 5
+#define PINE5 5
+#define PE6 6
+#define PORTE6 6
+#define DDE6 6
+#define PINE6 6
+#define PE7 7
+#define PORTE7 7
+#define DDE7 7
+#define PINE7 7
+#define PF0 0
+#define PORTF0 0
+#define DDF0 0
+#define PINF0 0
+#define PF1 1
+#define PORTF1 1
+#define DDF1 1
+#define PINF1 1
+#define PF2 2
+#define PORTF2 2
+#define DDF2 2
+#define PINF2 2
+#define PF3 3
+#define PORTF3 3
+#define DDF3 3
+#define PINF3 3
+#define PF4 4
+#define PORTF4 4
+#define DDF4 4
+#define PINF4 4
+#define PF5 5
+#define PORTF5 5
+#define DDF5 5
+#define PINF5 5
+#define PF6 6
+#define PORTF6 6
+#define DDF6 6
+#define PINF6 6
+#define PF7 7
+#define PORTF7 7
+#define DDF7 7
+#define PINF7 7
+#define PG0 0
+#define PORTG0 0
+#define DDG0 0
+#define PING0 0
+#define PG1 1
+#define PORTG1 1
+#define DDG1 1
+#define PING1 1
+#define PG2 2
+#define PORTG2 2
+#define DDG2 2
+#define PING2 2
+#define PG3 3
+#define PORTG3 3
+#define DDG3 3
+#define PING3 3
+#define PG4 4
+#define PORTG4 4
+#define DDG4 4
+#define PING4 4
+#define PG5 5
+#define PORTG5 5
+#define DDG5 5
+#define PING5 5
+#define PG6 6
+#define PORTG6 6
+#define DDG6 6
+#define PING6 6
+#define PG7 7
+#define PORTG7 7
+#define DDG7 7
+#define PING7 7
+#define PH0 0
+#define PORTH0 0
+#define DDH0 0
+#define PINH0 0
+#define PH1 1
+#define PORTH1 1
+#define DDH1 1
+#define PINH1 1
+#define PH2 2
+#define PORTH2 2
+#define DDH2 2
+#define PINH2 2
+#define PH3 3
+#define PORTH3 3
+#define DDH3 3
+#define PINH3 3
+#define PH4 4
+#define PORTH4 4
+#define DDH4 4
+#define PINH4 4
+#define PH5 5
+#define PORTH5 5
+#define DDH5 5
+#define PINH5 5
+#define PH6 6
+#define PORTH6 6
+#define DDH6 6
+#define PINH6 6
+#define PH7 7
+#define PORTH7 7
+#define DDH7 7
+#define PINH7 7
+#define PJ0 0
+#define PORTJ0 0
+#define DDJ0 0
+#define PINJ0 0
+#define PJ1 1
+#define PORTJ1 1
+#define DDJ1 1
+#define PINJ1 1
+#define PJ2 2
+#define PORTJ2 2
+#define DDJ2 2
+#define PINJ2 2
+#define PJ3 3
+#define PORTJ3 3
+#define DDJ3 3
+#define PINJ3 3
+#define PJ4 4
+#define PORTJ4 4
+#define DDJ4 4
+#define PINJ4 4
+#define PJ5 5
+#define PORTJ5 5
+#define DDJ5 5
+#define PINJ5 5
+#define PJ6 6
+#define PORTJ6 6
+#define DDJ6 6
+#define PINJ6 6
+#define PJ7 7
+#define PORTJ7 7
+#define DDJ7 7
+#define PINJ7 7
+#define PK0 0
+#define PORTK0 0
+#define DDK0 0
+#define PINK0 0
+#define PK1 1
+#define PORTK1 1
+#define DDK1 1
+#define PINK1 1
+#define PK2 2
+#define PORTK2 2
+#define DDK2 2
+#define PINK2 2
+#define PK3 3
+#define PORTK3 3
+#define DDK3 3
+#define PINK3 3
+#define PK4 4
+#define PORTK4 4
+#define DDK4 4
+#define PINK4 4
+#define PK5 5
+#define PORTK5 5
+#define DDK5 5
+#define PINK5 5
+#define PK6 6
+#define PORTK6 6
+#define DDK6 6
+#define PINK6 6
+#define PK7 7
+#define PORTK7 7
+#define DDK7 7
+#define PINK7 7
+#define PL0 0
+#define PORTL0 0
+#define DDL0 0
+#define PINL0 0
+#define PL1 1
+#define PORTL1 1
+#define DDL1 1
+#define PINL1 1
+#define PL2 2
+#define PORTL2 2
+#define DDL2 2
+#define PINL2 2
+#define PL3 3
+#define PORTL3 3
+#define DDL3 3
+#define PINL3 3
+#define PL4 4
+#define PORTL4 4
+#define DDL4 4
+#define PINL4 4
+#define PL5 5
+#define PORTL5 5
+#define DDL5 5
+#define PINL5 5
+#define PL6 6
+#define PORTL6 6
+#define DDL6 6
+#define PINL6 6
+#define PL7 7
+#define PORTL7 7
+#define DDL7 7
+#define PINL7 7
+
+// ステータスレジスタ
+#define SREG_I 7
+
+// 8bit タイマー
+#define COM0A1 7
+#define COM0A0 6
+#define COM0B1 5
+#define COM0B0 4
+#define WGM01 1
+#define WGM00 0
+#define FOC0A 7
+#define FOC0B 6
+#define WGM02 3
+#define CS02 2
+#define CS01 1
+#define CS00 0
+#define OCIE0B 2
+#define OCIE0A 1
+#define TOIE0 0
+#define OCF0B 2
+#define OCF0A 1
+#define TOV0 0
+#define COM2A1 7
+#define COM2A0 6
+#define COM2B1 5
+#define COM2B0 4
+#define WGM21 1
+#define WGM20 0
+#define FOC2A 7
+#define FOC2B 6
+#define WGM22 3
+#define CS22 2
+#define CS21 1
+#define CS20 0
+#define OCIE2B 2
+#define OCIE2A 1
+#define TOIE2 0
+#define OCF2B 2
+#define OCF2A 1
+#define TOV2 0
+#define AS2 5
+
+// 16bit タイマー
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define COM1C1 3
+#define COM1C0 2
+#define WGM11 1
+#define WGM10 0
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+#define FOC1A 7
+#define FOC1B 6
+#define FOC1C 5
+#define ICIE1 5
+#define OCIE1C 3
+#define OCIE1B 2
+#define OCIE1A 1
+#define TOIE1 0
+#define ICF1 5
+#define OCF1C 3
+#define OCF1B 2
+#define OCF1A 1
+#define TOV1 0
+#define COM3A1 7
+#define COM3A0 6
+#define COM3B1 5
+#define COM3B0 4
+#define COM3C1 3
+#define COM3C0 2
+#define WGM31 1
+#define WGM30 0
+#define ICNC3 7
+#define ICES3 6
+#define WGM33 4
+#define WGM32 3
+#define CS32 2
+#define CS31 1
+#define CS30 0
+#define FOC3A 7
+#define FOC3B 6
+#define FOC3C 5
+#define ICIE3 5
+#define OCIE3C 3
+#define OCIE3B 2
+#define OCIE3A 1
+#define TOIE3 0
+#define ICF3 5
+#define OCF3C 3
+#define OCF3B 2
+#define OCF3A 1
+#define TOV3 0
+#define COM4A1 7
+#define COM4A0 6
+#define COM4B1 5
+#define COM4B0 4
+#define COM4C1 3
+#define COM4C0 2
+#define WGM41 1
+#define WGM40 0
+#define ICNC4 7
+#define ICES4 6
+#define WGM43 4
+#define WGM42 3
+#define CS42 2
+#define CS41 1
+#define CS40 0
+#define FOC4A 7
+#define FOC4B 6
+#define FOC4C 5
+#define ICIE4 5
+#define OCIE4C 3
+#define OCIE4B 2
+#define OCIE4A 1
+#define TOIE4 0
+#define ICF4 5
+#define OCF4C 3
+#define OCF4B 2
+#define OCF4A 1
+#define TOV4 0
+#define COM5A1 7
+#define COM5A0 6
+#define COM5B1 5
+#define COM5B0 4
+#define COM5C1 3
+#define COM5C0 2
+#define WGM51 1
+#define WGM50 0
+#define ICNC5 7
+#define ICES5 6
+#define WGM53 4
+#define WGM52 3
+#define CS52 2
+#define CS51 1
+#define CS50 0
+#define FOC5A 7
+#define FOC5B 6
+#define FOC5C 5
+#define ICIE5 5
+#define OCIE5C 3
+#define OCIE5B 2
+#define OCIE5A 1
+#define TOIE5 0
+#define ICF5 5
+#define OCF5C 3
+#define OCF5B 2
+#define OCF5A 1
+#define TOV5 0
+
+// A/D 変換器
+#define REFS1 7
+#define REFS0 6
+#define ADLAR 5
+#define MUX4 4
+#define MUX3 3
+#define MUX2 2
+#define MUX1 1
+#define MUX0 0
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define ACME 6
+#define MUX5 3
+#define ADTS2 2
+#define ADTS1 1
+#define ADTS0 0
+#define ADC0D 0
+#define ADC8D 0
+#define ADC1D 1
+#define ADC9D 1
+#define ADC2D 2
+#define ADC10D 2
+#define ADC3D 3
+#define ADC11D 3
+#define ADC4D 4
+#define ADC12D 4
+#define ADC5D 5
+#define ADC13D 5
+#define ADC6D 6
+#define ADC14D 6
+#define ADC7D 7
+#define ADC15D 7
+
+// ピン変化割り込み・外部割り込み
+#define PCIE0 0
+#define PCIF0 0
+#define PCIE1 1
+#define PCIF1 1
+#define PCIE2 2
+#define PCIF2 2
+#define PCINT0 0
+#define PCINT1 1
+#define PCINT2 2
+#define PCINT3 3
+#define PCINT4 4
+#define PCINT5 5
+#define PCINT6 6
+#define PCINT7 7
+#define PCINT8 0
+#define PCINT9 1
+#define PCINT10 2
+#define PCINT11 3
+#define PCINT12 4
+#define PCINT13 5
+#define PCINT14 6
+#define PCINT15 7
+#define PCINT16 0
+#define PCINT17 1
+#define PCINT18 2
+#define PCINT19 3
+#define PCINT20 4
+#define PCINT21 5
+#define PCINT22 6
+#define PCINT23 7
+#define INT0 0
+#define INTF0 0
+#define INT1 1
+#define INTF1 1
+#define INT2 2
+#define INTF2 2
+#define INT3 3
+#define INTF3 3
+#define INT4 4
+#define INTF4 4
+#define INT5 5
+#define INTF5 5
+#define INT6 6
+#define INTF6 6
+#define INT7 7
+#define INTF7 7
+
+// USART0
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define DOR0 3
+#define UPE0 2
+#define U2X0 1
+#define MPCM0 0
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0 4
+#define TXEN0 3
+#define UCSZ02 2
+#define UCSZ01 2
+#define UCSZ00 1
+
+// 電源
+#define PRTWI 7
+#define PRTIM2 6
+#define PRTIM0 5
+#define PRTIM1 3
+#define PRSPI 2
+#define PRUSART0 1
+#define PRADC 0
+#define PRTIM5 5
+#define PRTIM4 4
+#define PRTIM3 3
+
+// 割り込みベクタ (ATmega2560 の番号)
+#define INT0_vect __vector_1
+#define INT0_vect_num 1
+#define INT1_vect __vector_2
+#define INT1_vect_num 2
+#define INT2_vect __vector_3
+#define INT2_vect_num 3
+#define INT3_vect __vector_4
+#define INT3_vect_num 4
+#define INT4_vect __vector_5
+#define INT4_vect_num 5
+#define INT5_vect __vector_6
+#define INT5_vect_num 6
+#define INT6_vect __vector_7
+#define INT6_vect_num 7
+#define INT7_vect __vector_8
+#define INT7_vect_num 8
+#define PCINT0_vect __vector_9
+#define PCINT0_vect_num 9
+#define PCINT1_vect __vector_10
+#define PCINT1_vect_num 10
+#define PCINT2_vect __vector_11
+#define PCINT2_vect_num 11
+#define WDT_vect __vector_12
+#define WDT_vect_num 12
+#define TIMER2_COMPA_vect __vector_13
+#define TIMER2_COMPA_vect_num 13
+#define TIMER2_COMPB_vect __vector_14
+#define TIMER2_COMPB_vect_num 14
+#define TIMER2_OVF_vect __vector_15
+#define TIMER2_OVF_vect_num 15
+#define TIMER1_CAPT_vect __vector_16
+#define TIMER1_CAPT_vect_num 16
+#define TIMER1_COMPA_vect __vector_17
+#define TIMER1_COMPA_vect_num 17
+#define TIMER1_COMPB_vect __vector_18
+#define TIMER1_COMPB_vect_num 18
+#define TIMER1_COMPC_vect __vector_19
+#define TIMER1_COMPC_vect_num 19
+#define TIMER1_OVF_vect __vector_20
+#define TIMER1_OVF_vect_num 20
+#define TIMER0_COMPA_vect __vector_21
+#define TIMER0_COMPA_vect_num 21
+#define TIMER0_COMPB_vect __vector_22
+#define TIMER0_COMPB_vect_num 22
+#define TIMER0_OVF_vect __vector_23
+#define TIMER0_OVF_vect_num 23
+#define SPI_STC_vect __vector_24
+#define SPI_STC_vect_num 24
+#define USART0_RX_vect __vector_25
+#define USART0_RX_vect_num 25
+#define USART0_UDRE_vect __vector_26
+#define USART0_UDRE_vect_num 26
+#define USART0_TX_vect __vector_27
+#define USART0_TX_vect_num 27
+#define ANALOG_COMP_vect __vector_28
+#define ANALOG_COMP_vect_num 28
+#define ADC_vect __vector_29
+#define ADC_vect_num 29
+#define EE_READY_vect __vector_30
+#define EE_READY_vect_num 30
+#define TIMER3_CAPT_vect __vector_31
+#define TIMER3_CAPT_vect_num 31
+#define TIMER3_COMPA_vect __vector_32
+#define TIMER3_COMPA_vect_num 32
+#define TIMER3_COMPB_vect __vector_33
+#define TIMER3_COMPB_vect_num 33
+#define TIMER3_COMPC_vect __vector_34
+#define TIMER3_COMPC_vect_num 34
+#define TIMER3_OVF_vect __vector_35
+#define TIMER3_OVF_vect_num 35
+#define USART1_RX_vect __vector_36
+#define USART1_RX_vect_num 36
+#define USART1_UDRE_vect __vector_37
+#define USART1_UDRE_vect_num 37
+#define USART1_TX_vect __vector_38
+#define USART1_TX_vect_num 38
+#define TWI_vect __vector_39
+#define TWI_vect_num 39
+#define SPM_READY_vect __vector_40
+#define SPM_READY_vect_num 40
+#define TIMER4_CAPT_vect __vector_41
+#define TIMER4_CAPT_vect_num 41
+#define TIMER4_COMPA_vect __vector_42
+#define TIMER4_COMPA_vect_num 42
+#define TIMER4_COMPB_vect __vector_43
+#define TIMER4_COMPB_vect_num 43
+#define TIMER4_COMPC_vect __vector_44
+#define TIMER4_COMPC_vect_num 44
+#define TIMER4_OVF_vect __vector_45
+#define TIMER4_OVF_vect_num 45
+#define TIMER5_CAPT_vect __vector_46
+#define TIMER5_CAPT_vect_num 46
+#define TIMER5_COMPA_vect __vector_47
+#define TIMER5_COMPA_vect_num 47
+#define TIMER5_COMPB_vect __vector_48
+#define TIMER5_COMPB_vect_num 48
+#define TIMER5_COMPC_vect __vector_49
+#define TIMER5_COMPC_vect_num 49
+#define TIMER5_OVF_vect __vector_50
+#define TIMER5_OVF_vect_num 50
+#define USART2_RX_vect __vector_51
+#define USART2_RX_vect_num 51
+#define USART2_UDRE_vect __vector_52
+#define USART2_UDRE_vect_num 52
+#define USART2_TX_vect __vector_53
+#define USART2_TX_vect_num 53
+#define USART3_RX_vect __vector_54
+#define USART3_RX_vect_num 54
+#define USART3_UDRE_vect __vector_55
+#define USART3_UDRE_vect_num 55
+#define USART3_TX_vect __vector_56
+#define USART3_TX_vect_num 56
+#define _VECTORS_SIZE 228
+
+#endif // SIM_AVR_IO_H
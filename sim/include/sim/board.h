@@ -0,0 +1,169 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 仮想ボード
+// CPU 時間をサイクル単位で進め、タイマー・A/D 変換・ピン変化の割り込みを発生させる。
+// 大会基板と自作基板の周辺回路 (マトリックス、7セグ、モーター等) の状態も追跡する。
+
+#ifndef SIM_BOARD_H
+#define SIM_BOARD_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace sim {
+
+/********
+ * 時間 *
+ ********/
+
+// 16MHz 換算のサイクル数
+const uint64_t CYCLES_PER_US = 16;
+const uint64_t CYCLES_PER_MS = 16000;
+
+// 現在のサイクル数
+uint64_t now();
+// 命令を実行した分だけ時間を進める (割り込み処理の時間は別に加算される)
+void charge(uint32_t cycles);
+// 指定時刻まで待つ (delay 用)
+void waitUntil(uint64_t cycle);
+// 割り込み処理中なら true
+bool inIsr();
+// 割り込み許可フラグ
+bool interruptsEnabled();
+
+/********
+ * 入力 *
+ ********/
+
+// ピン番号 (0〜69) の外部入力レベルを設定
+void setInput(uint8_t pin, bool level);
+// アナログ入力 (チャンネル 0〜15) を設定
+void setAnalog(uint8_t channel, uint16_t value);
+uint16_t analogValue(uint8_t channel);
+// 入力スクリプトの予約
+void scheduleInput(uint64_t cycle, uint8_t kind, uint8_t target, uint16_t value);
+enum InputKind : uint8_t { IN_PIN, IN_ANALOG, IN_LOAD, IN_COUPLE };
+
+/**************
+ * ボード構成 *
+ **************/
+
+struct Options {
+  // MODE_PIN (CN1-9) をラッチとして扱うか (false ならイネーブル)
+  bool mode_latch = true;
+  // フォトインタラプタを DC モーターの羽根と連動させる (0 で手動)
+  uint8_t photo_blades = 0;
+  // DC モーター
+  double motor_rpm_max = 3000.0;
+  double motor_tau_ms = 80.0;
+  double motor_load = 0.0;
+  // A/D 変換のノイズ幅 (LSB)
+  uint8_t adc_noise = 0;
+  // 乱数の種
+  uint32_t seed = 1;
+};
+Options& options();
+
+/**********
+ * 観測値 *
+ **********/
+
+// 出力ピンの現在レベル (PWM 中は High の割合)
+double pinLevel(uint8_t pin);
+
+struct Stats {
+  // マトリックス (列 0〜7、行 0〜7 の点灯時間サイクル)
+  uint64_t matrix_on[8][8];
+  uint32_t matrix_latches;
+  uint16_t matrix_row;
+  uint16_t matrix_col;
+  // 7セグ (セグメント毎の点灯時間)
+  uint64_t seg_on[8];
+  uint32_t seg_mode_edges;
+  uint32_t mode_edges;
+  // LED バー (セグメント毎の R, G, B, 点灯時間)
+  double bar_on[10][4];
+  // ステッピングモーター (半ステップ単位)
+  int32_t stepper_position;
+  uint32_t stepper_steps;
+  uint32_t stepper_skipped;
+  // DC モーター
+  double motor_rpm;
+  double motor_revs;
+  uint8_t motor_drive;
+  // サーボ
+  uint16_t servo_us;
+  uint32_t servo_writes;
+  uint32_t servo_changes;
+  // ブザー
+  uint32_t buzzer_starts;
+  uint64_t buzzer_on;
+  double buzzer_hz;
+  // フォトインタラプタ
+  uint32_t photo_edges;
+  // シリアル
+  uint64_t serial_tx;
+  uint64_t serial_rx;
+  uint32_t serial_blocked;
+  // 割り込み
+  uint32_t isr_calls[64];
+  uint64_t isr_cycles;
+  // 集計開始時刻
+  uint64_t since;
+};
+const Stats& stats();
+// 積算値をクリア (現在状態は残す)
+void resetStats();
+// 積算値を現在時刻まで更新
+void flushStats();
+
+// ピン変化のトレース (VCD)
+void traceOpen(FILE *out);
+void traceClose();
+
+/************
+ * シリアル *
+ ************/
+
+// 送受信の相手 (-1 で破棄)
+void serialAttach(int rx_fd, int tx_fd);
+// 送信データを受け取るコールバック (ホストで直接読む用)
+typedef void (*SerialSink)(uint8_t c, void *ctx);
+void serialSink(SerialSink sink, void *ctx);
+// 受信バッファへ直接書き込む
+void serialInject(const uint8_t *data, size_t size);
+
+/**********
+ * 内部用 *
+ **********/
+
+// Servo ライブラリから
+void servoPulse(uint8_t pin, uint16_t us);
+// USART0 の状態
+void serialBegin(unsigned long baud);
+void serialEnd();
+int serialAvailable();
+int serialPeek();
+int serialRead();
+int serialAvailableForWrite();
+void serialFlush();
+void serialWrite(uint8_t c);
+
+// 初期化 (Arduino コアの init() 相当のレジスタ状態)
+void reset();
+
+} // namespace sim
+
+#endif // SIM_BOARD_H
@@ -0,0 +1,108 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 仮想 ATmega2560 のレジスタ
+// 読み書きのたびに仮想ボードへ通知し、サイクル数を加算する。
+
+#ifndef SIM_REG_H
+#define SIM_REG_H
+
+#include <stdint.h>
+
+namespace sim {
+
+// レジスタ番号
+enum RegId : uint8_t {
+  // ポート (PIN, DDR, PORT の順で 3 個ずつ)
+  R_PINA, R_DDRA, R_PORTA,
+  R_PINB, R_DDRB, R_PORTB,
+  R_PINC, R_DDRC, R_PORTC,
+  R_PIND, R_DDRD, R_PORTD,
+  R_PINE, R_DDRE, R_PORTE,
+  R_PINF, R_DDRF, R_PORTF,
+  R_PING, R_DDRG, R_PORTG,
+  R_PINH, R_DDRH, R_PORTH,
+  R_PINJ, R_DDRJ, R_PORTJ,
+  R_PINK, R_DDRK, R_PORTK,
+  R_PINL, R_DDRL, R_PORTL,
+  // ステータス
+  R_SREG, R_GPIOR0, R_GPIOR1, R_GPIOR2,
+  // 8bit タイマー (0, 2)
+  R_TCCR0A, R_TCCR0B, R_TCNT0, R_OCR0A, R_OCR0B, R_TIMSK0, R_TIFR0,
+  R_TCCR2A, R_TCCR2B, R_TCNT2, R_OCR2A, R_OCR2B, R_TIMSK2, R_TIFR2, R_ASSR,
+  // 16bit タイマー制御 (1, 3, 4, 5)
+  R_TCCR1A, R_TCCR1B, R_TCCR1C, R_TIMSK1, R_TIFR1,
+  R_TCCR3A, R_TCCR3B, R_TCCR3C, R_TIMSK3, R_TIFR3,
+  R_TCCR4A, R_TCCR4B, R_TCCR4C, R_TIMSK4, R_TIFR4,
+  R_TCCR5A, R_TCCR5B, R_TCCR5C, R_TIMSK5, R_TIFR5,
+  // A/D 変換器
+  R_ADMUX, R_ADCSRA, R_ADCSRB, R_ADCL, R_ADCH, R_DIDR0, R_DIDR2,
+  // ピン変化割り込み・外部割り込み
+  R_PCICR, R_PCIFR, R_PCMSK0, R_PCMSK1, R_PCMSK2,
+  R_EICRA, R_EICRB, R_EIMSK, R_EIFR,
+  // USART0
+  R_UCSR0A, R_UCSR0B, R_UCSR0C, R_UDR0,
+  // 電源
+  R_PRR0, R_PRR1, R_SMCR, R_MCUSR,
+  REG8_COUNT
+};
+
+// 16bit レジスタ番号
+enum Reg16Id : uint8_t {
+  R_TCNT1, R_OCR1A, R_OCR1B, R_OCR1C, R_ICR1,
+  R_TCNT3, R_OCR3A, R_OCR3B, R_OCR3C, R_ICR3,
+  R_TCNT4, R_OCR4A, R_OCR4B, R_OCR4C, R_ICR4,
+  R_TCNT5, R_OCR5A, R_OCR5B, R_OCR5C, R_ICR5,
+  R_ADCW, R_UBRR0,
+  REG16_COUNT
+};
+
+uint8_t readReg8(uint8_t id);
+void writeReg8(uint8_t id, uint8_t value);
+uint16_t readReg16(uint8_t id);
+void writeReg16(uint8_t id, uint16_t value);
+
+// 8bit レジスタ
+struct Reg8 {
+  uint8_t id;
+  constexpr explicit Reg8(const uint8_t i) : id(i) {}
+  Reg8(const Reg8&) = delete;
+  operator uint8_t() const { return readReg8(id); }
+  Reg8& operator=(const uint8_t v) { writeReg8(id, v); return *this; }
+  Reg8& operator=(const Reg8& o) { writeReg8(id, (uint8_t) o); return *this; }
+  Reg8& operator|=(const uint8_t v) { writeReg8(id, readReg8(id) | v); return *this; }
+  Reg8& operator&=(const uint8_t v) { writeReg8(id, readReg8(id) & v); return *this; }
+  Reg8& operator^=(const uint8_t v) { writeReg8(id, readReg8(id) ^ v); return *this; }
+  Reg8& operator+=(const uint8_t v) { writeReg8(id, (uint8_t) (readReg8(id) + v)); return *this; }
+  Reg8& operator-=(const uint8_t v) { writeReg8(id, (uint8_t) (readReg8(id) - v)); return *this; }
+};
+
+// 16bit レジスタ
+struct Reg16 {
+  uint8_t id;
+  constexpr explicit Reg16(const uint8_t i) : id(i) {}
+  Reg16(const Reg16&) = delete;
+  operator uint16_t() const { return readReg16(id); }
+  Reg16& operator=(const uint16_t v) { writeReg16(id, v); return *this; }
+  Reg16& operator=(const Reg16& o) { writeReg16(id, (uint16_t) o); return *this; }
+  Reg16& operator|=(const uint16_t v) { writeReg16(id, readReg16(id) | v); return *this; }
+  Reg16& operator&=(const uint16_t v) { writeReg16(id, readReg16(id) & v); return *this; }
+  Reg16& operator^=(const uint16_t v) { writeReg16(id, readReg16(id) ^ v); return *this; }
+  Reg16& operator+=(const uint16_t v) { writeReg16(id, (uint16_t) (readReg16(id) + v)); return *this; }
+  Reg16& operator-=(const uint16_t v) { writeReg16(id, (uint16_t) (readReg16(id) - v)); return *this; }
+};
+
+} // namespace sim
+
+#endif // SIM_REG_H
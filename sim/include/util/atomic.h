@@ -0,0 +1,35 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 仮想 ATmega2560 の <util/atomic.h>
+
+#ifndef SIM_UTIL_ATOMIC_H
+#define SIM_UTIL_ATOMIC_H
+
+#include "avr/interrupt.h"
+
+namespace sim {
+struct AtomicRestore {
+  uint8_t sreg;
+  bool once;
+  AtomicRestore() : sreg(SREG), once(true) { cli(); }
+  ~AtomicRestore() { SREG = sreg; }
+};
+} // namespace sim
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (::sim::AtomicRestore _atomic_; _atomic_.once; _atomic_.once = false)
+
+#endif // SIM_UTIL_ATOMIC_H
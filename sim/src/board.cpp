@@ -0,0 +1,1333 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 仮想ボード本体
+// 時間は 16MHz のサイクル数で管理し、イベント (タイマー一致、A/D 変換完了、
+// 入力スクリプト、モーターの物理計算、シリアル送受信) を時刻順に処理する。
+
+#include "sim/board.h"
+#include "sim/reg.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+// 割り込みベクタ (スケッチ側で定義されていなければ NULL)
+extern "C" {
+#define SIM_VECTOR(n) void __vector_##n(void) __attribute__((weak));
+SIM_VECTOR(1) SIM_VECTOR(2) SIM_VECTOR(3) SIM_VECTOR(4) SIM_VECTOR(5) SIM_VECTOR(6) SIM_VECTOR(7) SIM_VECTOR(8)
+SIM_VECTOR(9) SIM_VECTOR(10) SIM_VECTOR(11) SIM_VECTOR(12) SIM_VECTOR(13) SIM_VECTOR(14) SIM_VECTOR(15) SIM_VECTOR(16)
+SIM_VECTOR(17) SIM_VECTOR(18) SIM_VECTOR(19) SIM_VECTOR(20) SIM_VECTOR(21) SIM_VECTOR(22) SIM_VECTOR(23) SIM_VECTOR(24)
+SIM_VECTOR(25) SIM_VECTOR(26) SIM_VECTOR(27) SIM_VECTOR(28) SIM_VECTOR(29) SIM_VECTOR(30) SIM_VECTOR(31) SIM_VECTOR(32)
+SIM_VECTOR(33) SIM_VECTOR(34) SIM_VECTOR(35) SIM_VECTOR(36) SIM_VECTOR(37) SIM_VECTOR(38) SIM_VECTOR(39) SIM_VECTOR(40)
+SIM_VECTOR(41) SIM_VECTOR(42) SIM_VECTOR(43) SIM_VECTOR(44) SIM_VECTOR(45) SIM_VECTOR(46) SIM_VECTOR(47) SIM_VECTOR(48)
+SIM_VECTOR(49) SIM_VECTOR(50) SIM_VECTOR(51) SIM_VECTOR(52) SIM_VECTOR(53) SIM_VECTOR(54) SIM_VECTOR(55) SIM_VECTOR(56)
+#undef SIM_VECTOR
+}
+
+namespace sim {
+
+namespace {
+
+typedef void (*Vector)(void);
+Vector const VECTORS[57] = {
+  nullptr, __vector_1, __vector_2, __vector_3, __vector_4, __vector_5, __vector_6, __vector_7, __vector_8,
+  __vector_9, __vector_10, __vector_11, __vector_12, __vector_13, __vector_14, __vector_15, __vector_16,
+  __vector_17, __vector_18, __vector_19, __vector_20, __vector_21, __vector_22, __vector_23, __vector_24,
+  __vector_25, __vector_26, __vector_27, __vector_28, __vector_29, __vector_30, __vector_31, __vector_32,
+  __vector_33, __vector_34, __vector_35, __vector_36, __vector_37, __vector_38, __vector_39, __vector_40,
+  __vector_41, __vector_42, __vector_43, __vector_44, __vector_45, __vector_46, __vector_47, __vector_48,
+  __vector_49, __vector_50, __vector_51, __vector_52, __vector_53, __vector_54, __vector_55, __vector_56
+};
+
+// 割り込み入口と出口のおおよそのコスト (ベクタジャンプ、退避、reti)
+const uint32_t ISR_OVERHEAD = 30;
+
+/**********
+ * ポート *
+ **********/
+
+enum PortIndex : uint8_t { P_A, P_B, P_C, P_D, P_E, P_F, P_G, P_H, P_J, P_K, P_L, PORT_COUNT };
+struct PinMap { uint8_t port; uint8_t bit; };
+// Arduino Mega 2560 のピン配置
+const PinMap PINS[70] = {
+  { P_E, 0 }, { P_E, 1 }, { P_E, 4 }, { P_E, 5 }, { P_G, 5 }, { P_E, 3 }, { P_H, 3 }, { P_H, 4 }, // 0-7
+  { P_H, 5 }, { P_H, 6 }, { P_B, 4 }, { P_B, 5 }, { P_B, 6 }, { P_B, 7 }, { P_J, 1 }, { P_J, 0 }, // 8-15
+  { P_H, 1 }, { P_H, 0 }, { P_D, 3 }, { P_D, 2 }, { P_D, 1 }, { P_D, 0 }, { P_A, 0 }, { P_A, 1 }, // 16-23
+  { P_A, 2 }, { P_A, 3 }, { P_A, 4 }, { P_A, 5 }, { P_A, 6 }, { P_A, 7 }, { P_C, 7 }, { P_C, 6 }, // 24-31
+  { P_C, 5 }, { P_C, 4 }, { P_C, 3 }, { P_C, 2 }, { P_C, 1 }, { P_C, 0 }, { P_D, 7 }, { P_G, 2 }, // 32-39
+  { P_G, 1 }, { P_G, 0 }, { P_L, 7 }, { P_L, 6 }, { P_L, 5 }, { P_L, 4 }, { P_L, 3 }, { P_L, 2 }, // 40-47
+  { P_L, 1 }, { P_L, 0 }, { P_B, 3 }, { P_B, 2 }, { P_B, 1 }, { P_B, 0 }, { P_F, 0 }, { P_F, 1 }, // 48-55
+  { P_F, 2 }, { P_F, 3 }, { P_F, 4 }, { P_F, 5 }, { P_F, 6 }, { P_F, 7 }, { P_K, 0 }, { P_K, 1 }, // 56-63
+  { P_K, 2 }, { P_K, 3 }, { P_K, 4 }, { P_K, 5 }, { P_K, 6 }, { P_K, 7 }                          // 64-69
+};
+
+struct Port { uint8_t port, ddr, ext; };
+
+/************
+ * タイマー *
+ ************/
+
+struct Timer {
+  bool wide;
+  uint8_t a, b, c, timsk, tifr;
+  uint16_t ocr[3], ocr_buf[3], icr;
+  uint16_t cnt;
+  uint64_t t_ref;
+  uint8_t v_capt, v_a, v_b, v_c, v_ovf;
+};
+
+enum Source : uint8_t { S_CAPT, S_A, S_B, S_C, S_OVF, S_BOTTOM, SOURCE_COUNT };
+
+/**********
+ * 状態 *
+ **********/
+
+struct State {
+  uint64_t now;
+  // 次のイベントの時刻 (horizon_ok の間は状態が変わらないので再計算しない)
+  uint64_t horizon;
+  bool horizon_ok;
+  bool ie;
+  uint8_t sreg;
+  int isr;
+  uint8_t regs[REG8_COUNT];
+  Port ports[PORT_COUNT];
+  Timer timers[6];
+  // A/D 変換
+  bool adc_busy;
+  bool adc_first;
+  uint64_t adc_end;
+  uint8_t adc_channel;
+  uint16_t adc_result;
+  uint16_t analog[16];
+  uint32_t rng;
+  // 入力スクリプト
+  struct Input { uint64_t at; uint8_t kind, target; uint16_t value; uint32_t order; };
+  std::vector<Input> inputs;
+  size_t input_next;
+  uint32_t input_order;
+  // マトリックス (74HC595 x2)
+  uint16_t shift;
+  uint8_t row, col;
+  uint64_t matrix_t;
+  // 7セグ・モーター
+  uint8_t seg_mask;
+  uint64_t seg_t;
+  uint8_t drv;
+  bool drv_enabled;
+  int8_t stepper_phase;
+  // LED バー
+  uint64_t bar_t;
+  // DC モーター
+  double omega;
+  double theta;
+  uint64_t motor_t;
+  bool photo_blocked;
+  // ブザー
+  uint64_t buzz_last;
+  uint64_t buzz_rise;
+  bool buzz_on;
+  // シリアル
+  bool serial_on;
+  uint32_t byte_cycles;
+  uint8_t tx[64];
+  uint8_t tx_head, tx_count;
+  uint64_t tx_next;
+  uint8_t rx[64];
+  uint8_t rx_head, rx_count;
+  uint64_t rx_poll;
+  int rx_fd = -1, tx_fd = -1;
+  SerialSink sink;
+  void *sink_ctx;
+  // トレース
+  FILE *vcd;
+  uint8_t vcd_last[PORT_COUNT];
+  Stats stats;
+};
+
+State g;
+Options g_options;
+
+/**************
+ * 補助関数 *
+ **************/
+
+inline uint8_t levels(const uint8_t p) {
+  const Port& port = g.ports[p];
+  return (port.ddr & port.port) | (~port.ddr & port.ext);
+}
+
+inline bool pinBit(const uint8_t pin) {
+  return levels(PINS[pin].port) & (1 << PINS[pin].bit);
+}
+
+uint32_t prescale(const uint8_t n) {
+  const Timer& t = g.timers[n];
+  const uint8_t cs = t.b & 7;
+  if (n == 2) {
+    static const uint16_t PS2[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+    return PS2[cs];
+  }
+  static const uint16_t PS[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+  return PS[cs];
+}
+
+uint8_t wgm(const uint8_t n) {
+  const Timer& t = g.timers[n];
+  if (t.wide) return ((t.b >> 3) & 3) << 2 | (t.a & 3);
+  return ((t.b >> 3) & 1) << 2 | (t.a & 3);
+}
+
+uint16_t top(const uint8_t n) {
+  const Timer& t = g.timers[n];
+  const uint8_t m = wgm(n);
+  if (t.wide) {
+    switch (m) {
+      case 1: case 5: return 0x00FF;
+      case 2: case 6: return 0x01FF;
+      case 3: case 7: return 0x03FF;
+      case 4: case 9: case 11: case 15: return t.ocr[0];
+      case 8: case 10: case 12: case 14: return t.icr;
+      default: return 0xFFFF;
+    }
+  }
+  return (m == 2 || m == 5 || m == 7) ? t.ocr[0] : 0xFF;
+}
+
+bool phaseCorrect(const uint8_t n) {
+  const uint8_t m = wgm(n);
+  if (g.timers[n].wide) return m == 1 || m == 2 || m == 3 || (m >= 8 && m <= 11);
+  return m == 1 || m == 5;
+}
+
+bool buffered(const uint8_t n) {
+  const uint8_t m = wgm(n);
+  if (g.timers[n].wide) return m != 0 && m != 4 && m != 12 && m != 13;
+  return m == 1 || m == 3 || m == 5 || m == 7;
+}
+
+// カウンタの周期 (クロック数)
+uint32_t period(const uint8_t n) {
+  const uint32_t p = (uint32_t) top(n) + 1;
+  return phaseCorrect(n) ? 2 * (p - 1) : p;
+}
+
+// カウンタの値 (位相基準 PWM では往復の位置から求める)
+uint16_t countValue(const uint8_t n) {
+  const Timer& t = g.timers[n];
+  if (!phaseCorrect(n)) return t.cnt;
+  const uint32_t tp = top(n);
+  return t.cnt <= tp ? t.cnt : (uint16_t) (2 * tp - t.cnt);
+}
+
+// 指定時刻までカウンタを進める
+void timerSync(const uint8_t n, const uint64_t when) {
+  Timer& t = g.timers[n];
+  const uint32_t ps = prescale(n);
+  if (!ps || when <= t.t_ref) {
+    if (!ps) t.t_ref = when;
+    return;
+  }
+  uint64_t ticks = (when - t.t_ref) / ps;
+  t.t_ref += ticks * ps;
+  const uint32_t maxv = t.wide ? 0xFFFF : 0xFF;
+  const uint32_t per = period(n);
+  bool crossed = false;
+  if (t.cnt >= per) {
+    const uint32_t to_wrap = maxv + 1 - t.cnt;
+    if (ticks < to_wrap) {
+      t.cnt += ticks;
+      return;
+    }
+    ticks -= to_wrap;
+    t.cnt = 0;
+    crossed = true;
+  }
+  if (ticks >= per - t.cnt) crossed = true;
+  t.cnt = (uint16_t) ((t.cnt + ticks) % per);
+  if (crossed) for (int i = 0; i < 3; i++) t.ocr[i] = t.ocr_buf[i];
+}
+
+// カウンタが値 v になるまでのクロック数 (0 は到達しない)
+uint64_t ticksTo(const uint8_t n, const uint32_t v) {
+  const Timer& t = g.timers[n];
+  const uint32_t maxv = t.wide ? 0xFFFF : 0xFF;
+  const uint32_t per = period(n);
+  if (t.cnt >= per) {
+    if (v > t.cnt) return v - t.cnt;
+    if (v >= per) return 0;
+    return (maxv + 1 - t.cnt) + v;
+  }
+  if (v >= per) return 0;
+  if (v > t.cnt) return v - t.cnt;
+  return per - t.cnt + v;
+}
+
+// タイマーの次のイベント
+bool timerNext(const uint8_t n, uint64_t *when, uint8_t *source) {
+  const Timer& t = g.timers[n];
+  const uint32_t ps = prescale(n);
+  if (!ps) return false;
+  const uint8_t m = wgm(n);
+  uint64_t best = 0;
+  uint8_t src = SOURCE_COUNT;
+  const uint32_t tp = top(n);
+  auto consider = [&](const uint8_t s, const uint64_t ticks) {
+    if (!ticks) return;
+    if (src == SOURCE_COUNT || ticks < best) {
+      best = ticks;
+      src = s;
+    }
+  };
+  const bool pc = phaseCorrect(n);
+  // 比較一致
+  if (!pc) {
+    if ((t.timsk & 0x02) && !(t.tifr & 0x02)) consider(S_A, ticksTo(n, t.ocr[0]));
+    if ((t.timsk & 0x04) && !(t.tifr & 0x04)) consider(S_B, ticksTo(n, t.ocr[1]));
+    if (t.wide && (t.timsk & 0x08) && !(t.tifr & 0x08)) consider(S_C, ticksTo(n, t.ocr[2]));
+  }
+  // 捕獲 (ICR が TOP の CTC / 高速 PWM)
+  if (t.wide && (t.timsk & 0x20) && !(t.tifr & 0x20) && (m == 12 || m == 14)) consider(S_CAPT, ticksTo(n, tp));
+  // 溢れ
+  const bool ovf_on = (t.timsk & 0x01) && !(t.tifr & 0x01);
+  const bool ctc = t.wide ? (m == 4 || m == 12) : (m == 2);
+  if (ovf_on && !ctc) consider(S_OVF, ticksTo(n, 0));
+  // バッファされた OCR の更新
+  if (buffered(n) && memcmp(t.ocr, t.ocr_buf, sizeof(t.ocr)) != 0) consider(S_BOTTOM, ticksTo(n, 0));
+  if (src == SOURCE_COUNT) return false;
+  *when = t.t_ref + best * ps;
+  *source = src;
+  return true;
+}
+
+/************
+ * 観測 *
+ ************/
+
+// OC ピンの PWM 出力 (High の割合、PWM でなければ負)
+double pwmFraction(const uint8_t pin) {
+  uint8_t n, ch;
+  switch (pin) {
+    case 2: n = 3; ch = 1; break;
+    case 3: n = 3; ch = 2; break;
+    case 4: n = 0; ch = 1; break;
+    case 5: n = 3; ch = 0; break;
+    case 6: n = 4; ch = 0; break;
+    case 7: n = 4; ch = 1; break;
+    case 8: n = 4; ch = 2; break;
+    case 9: n = 2; ch = 1; break;
+    case 10: n = 2; ch = 0; break;
+    case 11: n = 1; ch = 0; break;
+    case 12: n = 1; ch = 1; break;
+    case 13: n = 0; ch = 0; break;
+    case 44: n = 5; ch = 2; break;
+    case 45: n = 5; ch = 1; break;
+    case 46: n = 5; ch = 0; break;
+    default: return -1.0;
+  }
+  const Timer& t = g.timers[n];
+  const uint8_t com = (t.a >> (6 - 2 * ch)) & 3;
+  if (!com) return -1.0;
+  const PinMap& pm = PINS[pin];
+  if (!(g.ports[pm.port].ddr & (1 << pm.bit))) return -1.0;
+  if (!prescale(n) || !buffered(n)) return com == 1 ? 0.5 : -1.0;
+  const double tp = top(n);
+  const double o = t.ocr[ch];
+  double high;
+  if (phaseCorrect(n)) high = tp ? o / tp : 0.0;
+  else high = o >= tp ? 1.0 : (o + 1.0) / (tp + 1.0);
+  if (com == 3) high = 1.0 - high;
+  else if (com == 1) return -1.0;
+  return high < 0.0 ? 0.0 : (high > 1.0 ? 1.0 : high);
+}
+
+double level(const uint8_t pin) {
+  const double f = pwmFraction(pin);
+  if (f >= 0.0) return f;
+  return pinBit(pin) ? 1.0 : 0.0;
+}
+
+const uint8_t BAR_PINS[10] = { 22, 23, 24, 25, 26, 2, 3, 4, 5, 6 };
+const uint8_t RGB_PINS[3] = { 7, 8, 9 };
+
+void barIntegrate(const uint64_t t) {
+  if (t <= g.bar_t) return;
+  const double dt = (double) (t - g.bar_t);
+  g.bar_t = t;
+  double rgb[3];
+  for (int c = 0; c < 3; c++) rgb[c] = 1.0 - level(RGB_PINS[c]);
+  for (int i = 0; i < 10; i++) {
+    const double on = level(BAR_PINS[i]);
+    if (on <= 0.0) continue;
+    for (int c = 0; c < 3; c++) g.stats.bar_on[i][c] += dt * on * rgb[c];
+    g.stats.bar_on[i][3] += dt * on;
+  }
+}
+
+void matrixIntegrate(const uint64_t t) {
+  if (t <= g.matrix_t) return;
+  const uint64_t dt = t - g.matrix_t;
+  g.matrix_t = t;
+  if (!g.row || !g.col) return;
+  for (int c = 0; c < 8; c++) {
+    if (!(g.col & (1 << c))) continue;
+    for (int r = 0; r < 8; r++)
+      if (g.row & (1 << r)) g.stats.matrix_on[c][r] += dt;
+  }
+}
+
+void segIntegrate(const uint64_t t) {
+  if (t <= g.seg_t) return;
+  const uint64_t dt = t - g.seg_t;
+  g.seg_t = t;
+  for (int i = 0; i < 8; i++)
+    if (g.seg_mask & (1 << i)) g.stats.seg_on[i] += dt;
+}
+
+// 1相〜半ステップの位相 (コイル 1〜4 のパターンから)
+int8_t stepperPhase(const uint8_t coils) {
+  switch (coils) {
+    case 0x8: return 0;
+    case 0xC: return 1;
+    case 0x4: return 2;
+    case 0x6: return 3;
+    case 0x2: return 4;
+    case 0x3: return 5;
+    case 0x1: return 6;
+    case 0x9: return 7;
+    default: return -1;
+  }
+}
+
+void motorUpdate(const uint64_t t);
+
+// DRV8835 とステッピングモーターの FET の入力
+void driverUpdate() {
+  const uint8_t bus = levels(P_C);
+  const bool mode = levels(P_A) & 0x80;
+  bool enabled = g.drv_enabled;
+  uint8_t drv = g.drv;
+  if (mode) {
+    drv = bus;
+    enabled = true;
+  } else if (!g_options.mode_latch) {
+    enabled = false;
+  }
+  if (drv == g.drv && enabled == g.drv_enabled) return;
+  motorUpdate(g.now);
+  g.drv = drv;
+  g.drv_enabled = enabled;
+  // DC モーター: IN1 = PC7, IN2 = PC6
+  const uint8_t in = enabled ? (drv >> 6) & 3 : 0;
+  static const uint8_t DRIVE[4] = { 0 /* F */, 1 /* RT */, 2 /* LT */, 3 /* S */ };
+  g.stats.motor_drive = DRIVE[((in & 2) ? 2 : 0) | ((in & 1) ? 1 : 0)];
+  // ステッピングモーター: コイル 1〜4 = PC5〜PC2
+  const int8_t phase = enabled ? stepperPhase((drv >> 2) & 0xF) : -1;
+  if (phase >= 0 && g.stepper_phase >= 0 && phase != g.stepper_phase) {
+    int8_t d = (int8_t) ((phase - g.stepper_phase) & 7);
+    if (d == 4) {
+      g.stats.stepper_skipped++;
+    } else {
+      if (d > 4) d -= 8;
+      g.stats.stepper_position += d;
+      g.stats.stepper_steps++;
+    }
+  }
+  if (phase >= 0) g.stepper_phase = phase;
+}
+
+// 7セグの表示 (SEG_MODE = PA6 が High の間)
+void segUpdate() {
+  const uint8_t bus = levels(P_C);
+  uint8_t mask = 0;
+  if (levels(P_A) & 0x40) {
+    // L1 = PC5, L2 = PC4, C1 = PC0, C2 = PC6, C3 = PC3, R1 = PC1, R2 = PC2, POINT = PC7
+    static const uint8_t BIT[8] = { 5, 4, 0, 6, 3, 1, 2, 7 };
+    for (int i = 0; i < 8; i++)
+      if (bus & (1 << BIT[i])) mask |= 1 << i;
+  }
+  if (mask != g.seg_mask) {
+    segIntegrate(g.now);
+    g.seg_mask = mask;
+  }
+}
+
+void setExternal(uint8_t pin, bool value);
+
+void photoUpdate() {
+  if (!g_options.photo_blades) return;
+  const double f = g.theta * g_options.photo_blades;
+  const bool blocked = (f - floor(f)) < 0.25;
+  if (blocked != g.photo_blocked) {
+    g.photo_blocked = blocked;
+    setExternal(42, !blocked);
+  }
+}
+
+void motorUpdate(const uint64_t t) {
+  if (t <= g.motor_t) return;
+  const double dt = (double) (t - g.motor_t) / (double) (CYCLES_PER_MS * 1000);
+  g.motor_t = t;
+  const double max_rps = g_options.motor_rpm_max / 60.0 * (1.0 - g_options.motor_load);
+  double target = 0.0;
+  double tau = g_options.motor_tau_ms / 1000.0;
+  switch (g.stats.motor_drive) {
+    case 1: target = max_rps; break;
+    case 2: target = -max_rps; break;
+    case 3: tau /= 4.0; break;
+    default: tau *= 3.0; break;
+  }
+  const double e = exp(-dt / tau);
+  const double w0 = g.omega;
+  g.omega = target + (w0 - target) * e;
+  if (fabs(g.omega) < 1e-6 && target == 0.0) g.omega = 0.0;
+  const double dtheta = target * dt + (w0 - target) * tau * (1.0 - e);
+  g.theta += dtheta;
+  g.stats.motor_revs += fabs(dtheta);
+  g.stats.motor_rpm = g.omega * 60.0;
+  photoUpdate();
+}
+
+// 物理計算の刻み
+const uint64_t MOTOR_STEP = 25 * CYCLES_PER_US;
+
+bool motorActive() {
+  return g_options.photo_blades && (g.omega != 0.0 || g.stats.motor_drive == 1 || g.stats.motor_drive == 2);
+}
+
+// 周波数は立ち上がりの間隔から (デューティ比で音量を変えても正しく測る)
+void buzzerEdge(const uint64_t t, const bool rising) {
+  const uint64_t gap = t - g.buzz_last;
+  if (!g.buzz_on || gap > 20 * CYCLES_PER_MS) {
+    g.stats.buzzer_starts++;
+    g.buzz_on = true;
+    g.buzz_rise = 0;
+  } else {
+    g.stats.buzzer_on += gap;
+  }
+  if (rising) {
+    if (g.buzz_rise) g.stats.buzzer_hz = (double) (CYCLES_PER_MS * 1000) / (double) (t - g.buzz_rise);
+    g.buzz_rise = t;
+  }
+  g.buzz_last = t;
+}
+
+void vcdWrite(const uint8_t p, const uint8_t lv) {
+  if (!g.vcd || lv == g.vcd_last[p]) return;
+  fprintf(g.vcd, "#%llu\n", (unsigned long long) (g.now * 62500ULL));
+  for (int pin = 0; pin < 70; pin++) {
+    if (PINS[pin].port != p) continue;
+    const uint8_t m = 1 << PINS[pin].bit;
+    if ((lv ^ g.vcd_last[p]) & m) fprintf(g.vcd, "%c%c\n", (lv & m) ? '1' : '0', 33 + pin);
+  }
+  g.vcd_last[p] = lv;
+}
+
+// ピンのレベルが変わった時の処理
+void levelsChanged(const uint8_t p, const uint8_t old_lv, const uint8_t new_lv) {
+  const uint8_t diff = old_lv ^ new_lv;
+  if (!diff) return;
+  vcdWrite(p, new_lv);
+  // ピン変化割り込み
+  switch (p) {
+    case P_B:
+      if (diff & g.regs[R_PCMSK0]) g.regs[R_PCIFR] |= 0x01;
+      break;
+    case P_E:
+      if ((diff & 0x01) && (g.regs[R_PCMSK1] & 0x01)) g.regs[R_PCIFR] |= 0x02;
+      break;
+    case P_J:
+      if (((diff & 0x7F) << 1) & g.regs[R_PCMSK1]) g.regs[R_PCIFR] |= 0x02;
+      break;
+    case P_K:
+      if (diff & g.regs[R_PCMSK2]) g.regs[R_PCIFR] |= 0x04;
+      break;
+    case P_L:
+      if (diff & 0x80) g.stats.photo_edges++;
+      break;
+    default:
+      break;
+  }
+  // LED バー・RGB
+  if ((p == P_A && (diff & 0x1F)) || (p == P_E && (diff & 0x38)) || (p == P_G && (diff & 0x20)) ||
+      (p == P_H && (diff & 0x78))) {
+    barIntegrate(g.now);
+  }
+  // マトリックス
+  if (p == P_G) {
+    // ラッチが先 (シフトクロックと同時なら 1 つ前の内容が出る)
+    if ((diff & 0x02) && (new_lv & 0x02)) {
+      matrixIntegrate(g.now);
+      g.row = g.shift >> 8;
+      g.col = g.shift & 0xFF;
+      g.stats.matrix_latches++;
+      g.stats.matrix_row = g.row;
+      g.stats.matrix_col = g.col;
+    }
+    if ((diff & 0x04) && (new_lv & 0x04)) g.shift = (uint16_t) ((g.shift << 1) | ((levels(P_D) >> 7) & 1));
+  }
+  // 7セグ・モーター
+  if (p == P_C || (p == P_A && (diff & 0xC0))) {
+    if (p == P_A && (diff & 0x80)) g.stats.mode_edges++;
+    if (p == P_A && (diff & 0x40)) g.stats.seg_mode_edges++;
+    segUpdate();
+    driverUpdate();
+  }
+  // ブザー
+  if (p == P_A && (diff & 0x20)) buzzerEdge(g.now, (new_lv & 0x20) != 0);
+}
+
+void portWrite(const uint8_t p, const uint8_t port, const uint8_t ddr) {
+  const uint8_t old_lv = levels(p);
+  const bool bar_pwm = (p == P_H || p == P_E || p == P_G);
+  if (bar_pwm) barIntegrate(g.now);
+  g.ports[p].port = port;
+  g.ports[p].ddr = ddr;
+  levelsChanged(p, old_lv, levels(p));
+}
+
+void setExternal(const uint8_t pin, const bool value) {
+  const PinMap& pm = PINS[pin];
+  Port& port = g.ports[pm.port];
+  const uint8_t old_lv = levels(pm.port);
+  if (value) port.ext |= 1 << pm.bit;
+  else port.ext &= ~(1 << pm.bit);
+  levelsChanged(pm.port, old_lv, levels(pm.port));
+}
+
+/************
+ * A/D 変換 *
+ ************/
+
+uint16_t adcSample(const uint8_t ch) {
+  int v = g.analog[ch & 15];
+  if (g_options.adc_noise) {
+    g.rng = g.rng * 1103515245u + 12345u;
+    const int span = 2 * g_options.adc_noise + 1;
+    v += (int) ((g.rng >> 16) % span) - g_options.adc_noise;
+  }
+  return (uint16_t) (v < 0 ? 0 : (v > 1023 ? 1023 : v));
+}
+
+void adcStart(const uint64_t when) {
+  static const uint8_t DIV[8] = { 2, 2, 4, 8, 16, 32, 64, 128 };
+  const uint32_t clocks = g.adc_first ? 25 : 13;
+  g.adc_first = false;
+  g.adc_busy = true;
+  g.adc_channel = (g.regs[R_ADMUX] & 0x07) | ((g.regs[R_ADCSRB] & 0x08) ? 8 : 0);
+  g.adc_end = when + (uint64_t) clocks * DIV[g.regs[R_ADCSRA] & 7];
+}
+
+void adcComplete() {
+  const uint16_t v = adcSample(g.adc_channel);
+  g.adc_result = (g.regs[R_ADMUX] & 0x20) ? (uint16_t) (v << 6) : v;
+  g.adc_busy = false;
+  g.regs[R_ADCSRA] |= 0x10;
+  // フリーランニング
+  if ((g.regs[R_ADCSRA] & 0xA0) == 0xA0 && (g.regs[R_ADCSRB] & 7) == 0) adcStart(g.adc_end);
+}
+
+/************
+ * シリアル *
+ ************/
+
+void serialEmit(const uint8_t c) {
+  g.stats.serial_tx++;
+  if (g.sink) g.sink(c, g.sink_ctx);
+  if (g.tx_fd >= 0) {
+    while (write(g.tx_fd, &c, 1) < 0 && errno == EINTR) {
+    }
+  }
+}
+
+void serialPoll() {
+  if (g.rx_fd < 0) return;
+  uint8_t buf[64];
+  const size_t room = sizeof(g.rx) - g.rx_count;
+  if (!room) return;
+  const ssize_t n = read(g.rx_fd, buf, room);
+  if (n > 0) serialInject(buf, (size_t) n);
+}
+
+/**************
+ * イベント *
+ **************/
+
+enum EventKind : uint8_t { E_NONE, E_TIMER, E_ADC, E_INPUT, E_MOTOR, E_TX, E_RX };
+
+struct Event {
+  uint64_t at;
+  EventKind kind;
+  uint8_t index;
+  uint8_t source;
+};
+
+Event nextEvent() {
+  Event e = { 0, E_NONE, 0, 0 };
+  auto take = [&](const uint64_t at, const EventKind k, const uint8_t i, const uint8_t s) {
+    if (e.kind == E_NONE || at < e.at) e = { at, k, i, s };
+  };
+  for (uint8_t n = 0; n < 6; n++) {
+    uint64_t at;
+    uint8_t s;
+    if (timerNext(n, &at, &s)) take(at, E_TIMER, n, s);
+  }
+  if (g.adc_busy) take(g.adc_end, E_ADC, 0, 0);
+  if (g.input_next < g.inputs.size()) take(g.inputs[g.input_next].at, E_INPUT, 0, 0);
+  if (motorActive()) take(g.motor_t + MOTOR_STEP, E_MOTOR, 0, 0);
+  if (g.tx_count) take(g.tx_next, E_TX, 0, 0);
+  if (g.rx_fd >= 0) take(g.rx_poll, E_RX, 0, 0);
+  return e;
+}
+
+void applyInput(const State::Input& in) {
+  switch (in.kind) {
+    case IN_PIN: setExternal(in.target, in.value != 0); break;
+    case IN_ANALOG: g.analog[in.target & 15] = in.value; break;
+    case IN_LOAD:
+      motorUpdate(in.at);
+      g_options.motor_load = in.value / 1000.0;
+      break;
+    case IN_COUPLE:
+      motorUpdate(in.at);
+      g_options.photo_blades = (uint8_t) in.value;
+      photoUpdate();
+      break;
+  }
+}
+
+void process(const Event& e) {
+  g.horizon_ok = false;
+  const uint64_t saved = g.now;
+  // 観測用の時刻はイベント発生時刻に合わせる
+  if (e.at < g.now) g.now = e.at;
+  switch (e.kind) {
+    case E_TIMER: {
+      Timer& t = g.timers[e.index];
+      const bool pwm_pins = (e.index == 2 || e.index == 4);
+      if (pwm_pins) barIntegrate(e.at);
+      timerSync(e.index, e.at);
+      static const uint8_t FLAG[SOURCE_COUNT] = { 0x20, 0x02, 0x04, 0x08, 0x01, 0x00 };
+      t.tifr |= FLAG[e.source];
+      break;
+    }
+    case E_ADC:
+      adcComplete();
+      break;
+    case E_INPUT:
+      applyInput(g.inputs[g.input_next++]);
+      break;
+    case E_MOTOR:
+      motorUpdate(e.at);
+      break;
+    case E_TX:
+      serialEmit(g.tx[g.tx_head]);
+      g.tx_head = (g.tx_head + 1) % sizeof(g.tx);
+      g.tx_count--;
+      g.tx_next = e.at + g.byte_cycles;
+      break;
+    case E_RX:
+      serialPoll();
+      g.rx_poll = e.at + CYCLES_PER_MS;
+      break;
+    case E_NONE:
+      break;
+  }
+  g.now = saved > e.at ? saved : e.at;
+}
+
+// 保留中の割り込みのうち優先度が最も高いもの
+int pending() {
+  const uint8_t pc = g.regs[R_PCICR] & g.regs[R_PCIFR];
+  if (pc & 1) return 9;
+  if (pc & 2) return 10;
+  if (pc & 4) return 11;
+  auto timer = [&](const uint8_t n) -> int {
+    const Timer& t = g.timers[n];
+    const uint8_t f = t.timsk & t.tifr;
+    if (!f) return 0;
+    if ((f & 0x20) && t.v_capt) return t.v_capt;
+    if (f & 0x02) return t.v_a;
+    if (f & 0x04) return t.v_b;
+    if ((f & 0x08) && t.v_c) return t.v_c;
+    if (f & 0x01) return t.v_ovf;
+    return 0;
+  };
+  int v;
+  if ((v = timer(2))) return v;
+  if ((v = timer(1))) return v;
+  if ((v = timer(0))) return v;
+  if ((g.regs[R_ADCSRA] & 0x18) == 0x18) return 29;
+  if ((v = timer(3))) return v;
+  if ((v = timer(4))) return v;
+  if ((v = timer(5))) return v;
+  return 0;
+}
+
+void clearFlag(const int vector) {
+  if (vector >= 9 && vector <= 11) {
+    g.regs[R_PCIFR] &= ~(1 << (vector - 9));
+    return;
+  }
+  if (vector == 29) {
+    g.regs[R_ADCSRA] &= ~0x10;
+    return;
+  }
+  for (int n = 0; n < 6; n++) {
+    Timer& t = g.timers[n];
+    if (vector == t.v_capt) t.tifr &= ~0x20;
+    else if (vector == t.v_a) t.tifr &= ~0x02;
+    else if (vector == t.v_b) t.tifr &= ~0x04;
+    else if (vector == t.v_c) t.tifr &= ~0x08;
+    else if (vector == t.v_ovf) t.tifr &= ~0x01;
+  }
+}
+
+void dispatch() {
+  while (g.ie && !g.isr) {
+    const int v = pending();
+    if (!v) return;
+    clearFlag(v);
+    if (!VECTORS[v]) {
+      fprintf(stderr, "sim: __vector_%d has no handler (__bad_interrupt)\n", v);
+      abort();
+    }
+    const uint64_t start = g.now;
+    g.isr++;
+    g.ie = false;
+    g.now += ISR_OVERHEAD;
+    VECTORS[v]();
+    g.ie = true;
+    g.isr--;
+    g.stats.isr_calls[v]++;
+    g.stats.isr_cycles += g.now - start;
+  }
+}
+
+void runUntil(const uint64_t limit, const bool extend) {
+  uint64_t remaining = limit - g.now;
+  for (;;) {
+    const Event e = nextEvent();
+    const uint64_t end = extend ? g.now + remaining : limit;
+    if (e.kind == E_NONE || e.at > end) {
+      g.now = end > g.now ? end : g.now;
+      dispatch();
+      const Event next = nextEvent();
+      g.horizon = next.kind == E_NONE ? UINT64_MAX : next.at;
+      g.horizon_ok = true;
+      return;
+    }
+    if (e.at > g.now) {
+      if (extend) remaining -= e.at - g.now;
+      g.now = e.at;
+    }
+    process(e);
+    dispatch();
+  }
+}
+
+} // namespace
+
+/********
+ * 時間 *
+ ********/
+
+uint64_t now() {
+  return g.now;
+}
+
+void charge(const uint32_t cycles) {
+  // 割り込み中か、次のイベントまで何も起きない間は時間を進めるだけ
+  if (g.isr || (g.horizon_ok && g.now + cycles < g.horizon)) {
+    g.now += cycles;
+    return;
+  }
+  runUntil(g.now + cycles, true);
+}
+
+void waitUntil(const uint64_t cycle) {
+  if (cycle <= g.now) return;
+  if (g.isr) {
+    g.now = cycle;
+    return;
+  }
+  runUntil(cycle, false);
+}
+
+bool inIsr() {
+  return g.isr != 0;
+}
+
+bool interruptsEnabled() {
+  return g.ie;
+}
+
+void cli() {
+  g.ie = false;
+  charge(1);
+}
+
+void sei() {
+  g.ie = true;
+  g.horizon_ok = false;
+  charge(1);
+}
+
+/********
+ * 入力 *
+ ********/
+
+void setInput(const uint8_t pin, const bool level) {
+  g.horizon_ok = false;
+  if (pin < 70) setExternal(pin, level);
+}
+
+void setAnalog(const uint8_t channel, const uint16_t value) {
+  g.horizon_ok = false;
+  g.analog[channel & 15] = value > 1023 ? 1023 : value;
+}
+
+uint16_t analogValue(const uint8_t channel) {
+  return adcSample(channel);
+}
+
+void scheduleInput(const uint64_t cycle, const uint8_t kind, const uint8_t target, const uint16_t value) {
+  State::Input in = { cycle, kind, target, value, g.input_order++ };
+  g.horizon_ok = false;
+  auto it = std::upper_bound(g.inputs.begin() + g.input_next, g.inputs.end(), in,
+                             [](const State::Input& x, const State::Input& y) { return x.at < y.at; });
+  g.inputs.insert(it, in);
+}
+
+Options& options() {
+  return g_options;
+}
+
+/**********
+ * 観測値 *
+ **********/
+
+double pinLevel(const uint8_t pin) {
+  return pin < 70 ? level(pin) : 0.0;
+}
+
+const Stats& stats() {
+  return g.stats;
+}
+
+void flushStats() {
+  matrixIntegrate(g.now);
+  segIntegrate(g.now);
+  barIntegrate(g.now);
+  motorUpdate(g.now);
+}
+
+void resetStats() {
+  flushStats();
+  Stats& s = g.stats;
+  memset(s.matrix_on, 0, sizeof(s.matrix_on));
+  memset(s.seg_on, 0, sizeof(s.seg_on));
+  memset(s.bar_on, 0, sizeof(s.bar_on));
+  memset(s.isr_calls, 0, sizeof(s.isr_calls));
+  s.matrix_latches = 0;
+  s.seg_mode_edges = 0;
+  s.mode_edges = 0;
+  s.stepper_steps = 0;
+  s.stepper_skipped = 0;
+  s.motor_revs = 0.0;
+  s.servo_writes = 0;
+  s.servo_changes = 0;
+  s.buzzer_starts = 0;
+  s.buzzer_on = 0;
+  s.photo_edges = 0;
+  s.serial_tx = 0;
+  s.serial_rx = 0;
+  s.serial_blocked = 0;
+  s.isr_cycles = 0;
+  s.since = g.now;
+}
+
+void traceOpen(FILE *out) {
+  g.vcd = out;
+  if (!out) return;
+  fprintf(out, "$timescale 1ps $end\n$scope module mega2560 $end\n");
+  for (int pin = 0; pin < 70; pin++) fprintf(out, "$var wire 1 %c D%d $end\n", 33 + pin, pin);
+  fprintf(out, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+  for (int p = 0; p < PORT_COUNT; p++) g.vcd_last[p] = levels(p);
+  for (int pin = 0; pin < 70; pin++) fprintf(out, "%c%c\n", pinBit(pin) ? '1' : '0', 33 + pin);
+  fprintf(out, "$end\n");
+}
+
+void traceClose() {
+  if (g.vcd) fflush(g.vcd);
+  g.vcd = nullptr;
+}
+
+/************
+ * シリアル *
+ ************/
+
+void serialAttach(const int rx_fd, const int tx_fd) {
+  g.horizon_ok = false;
+  g.rx_fd = rx_fd;
+  g.tx_fd = tx_fd;
+  g.rx_poll = g.now;
+}
+
+void serialSink(const SerialSink sink, void *ctx) {
+  g.sink = sink;
+  g.sink_ctx = ctx;
+}
+
+void serialInject(const uint8_t *data, size_t size) {
+  g.horizon_ok = false;
+  while (size-- && g.rx_count < sizeof(g.rx)) {
+    g.rx[(g.rx_head + g.rx_count) % sizeof(g.rx)] = *data++;
+    g.rx_count++;
+    g.stats.serial_rx++;
+  }
+}
+
+void serialBegin(const unsigned long baud) {
+  g.horizon_ok = false;
+  g.serial_on = true;
+  // 実機の UBRR の丸めは無視する
+  g.byte_cycles = (uint32_t) ((10ULL * CYCLES_PER_MS * 1000 + baud / 2) / baud);
+  if (!g.byte_cycles) g.byte_cycles = 1;
+  g.tx_next = g.now + g.byte_cycles;
+}
+
+void serialEnd() {
+  g.horizon_ok = false;
+  serialFlush();
+  g.serial_on = false;
+}
+
+int serialAvailable() {
+  charge(12);
+  return g.rx_count;
+}
+
+int serialPeek() {
+  charge(12);
+  return g.rx_count ? g.rx[g.rx_head] : -1;
+}
+
+int serialRead() {
+  charge(20);
+  if (!g.rx_count) return -1;
+  const uint8_t c = g.rx[g.rx_head];
+  g.rx_head = (g.rx_head + 1) % sizeof(g.rx);
+  g.rx_count--;
+  return c;
+}
+
+int serialAvailableForWrite() {
+  charge(12);
+  return (int) (sizeof(g.tx) - 1 - g.tx_count);
+}
+
+void serialFlush() {
+  while (g.tx_count) {
+    if (g.isr || !g.ie) {
+      // 割り込み禁止中は UDRE を直接待つ
+      g.now = g.tx_next > g.now ? g.tx_next : g.now;
+      process({ g.tx_next, E_TX, 0, 0 });
+    } else {
+      waitUntil(g.tx_next);
+    }
+  }
+}
+
+void serialWrite(const uint8_t c) {
+  if (!g.serial_on) return;
+  charge(40);
+  if (!g.tx_count && g.tx_next < g.now) g.tx_next = g.now + g.byte_cycles;
+  // 実機のバッファは 64 バイトのうち 63 バイトまで
+  while (g.tx_count >= sizeof(g.tx) - 1) {
+    g.stats.serial_blocked++;
+    if (g.isr || !g.ie) {
+      g.now = g.tx_next > g.now ? g.tx_next : g.now;
+      process({ g.tx_next, E_TX, 0, 0 });
+    } else {
+      waitUntil(g.tx_next);
+    }
+  }
+  g.tx[(g.tx_head + g.tx_count) % sizeof(g.tx)] = c;
+  g.tx_count++;
+  g.horizon_ok = false;
+}
+
+/**********
+ * 内部用 *
+ **********/
+
+void servoPulse(const uint8_t pin, const uint16_t us) {
+  (void) pin;
+  g.stats.servo_writes++;
+  if (us != g.stats.servo_us) g.stats.servo_changes++;
+  g.stats.servo_us = us;
+}
+
+void reset() {
+  g.horizon_ok = false;
+  FILE *vcd = g.vcd;
+  const SerialSink sink = g.sink;
+  void *ctx = g.sink_ctx;
+  const int rx_fd = g.rx_fd, tx_fd = g.tx_fd;
+  std::vector<State::Input> inputs;
+  inputs.swap(g.inputs);
+  g.~State();
+  new (&g) State();
+  g.inputs.swap(inputs);
+  g.input_next = 0;
+  g.vcd = vcd;
+  g.sink = sink;
+  g.sink_ctx = ctx;
+  g.rx_fd = rx_fd;
+  g.tx_fd = tx_fd;
+  g.rng = g_options.seed;
+  // 外部入力の初期値 (フォトインタラプタは非遮光で High)
+  for (int p = 0; p < PORT_COUNT; p++) g.ports[p].ext = 0;
+  g.ports[P_L].ext = 0x80;
+  // 割り込みベクタ番号
+  const uint8_t vec[6][5] = {
+    { 0, 21, 22, 0, 23 }, { 16, 17, 18, 19, 20 }, { 0, 13, 14, 0, 15 },
+    { 31, 32, 33, 34, 35 }, { 41, 42, 43, 44, 45 }, { 46, 47, 48, 49, 50 }
+  };
+  for (int n = 0; n < 6; n++) {
+    Timer& t = g.timers[n];
+    t.wide = (n != 0 && n != 2);
+    t.v_capt = vec[n][0];
+    t.v_a = vec[n][1];
+    t.v_b = vec[n][2];
+    t.v_c = vec[n][3];
+    t.v_ovf = vec[n][4];
+  }
+  // Arduino コアの init() と同じ設定
+  g.timers[0].a = 0x03;                            // 高速 PWM
+  g.timers[0].b = 0x03;                            // 1/64
+  g.timers[0].timsk = 0x01;                        // millis 用
+  for (int n : { 1, 3, 4, 5 }) {
+    g.timers[n].a = 0x01;                          // 8bit 位相基準 PWM
+    g.timers[n].b = 0x03;                          // 1/64
+  }
+  g.timers[2].a = 0x01;
+  g.timers[2].b = 0x04;                            // 1/64
+  g.regs[R_ADCSRA] = 0x87;                         // 有効、1/128
+  g.adc_first = true;
+  g.regs[R_SREG] = 0;
+  g.ie = true;
+  g.stats.servo_us = 0;
+}
+
+/**************
+ * レジスタ *
+ **************/
+
+namespace {
+
+// I/O 空間 (in/out で 1 サイクル) かどうか
+bool ioSpace(const uint8_t id) {
+  if (id <= R_PORTG) return true;
+  switch (id) {
+    case R_SREG: case R_GPIOR0: case R_GPIOR1: case R_GPIOR2:
+    case R_TCCR0A: case R_TCCR0B: case R_TCNT0: case R_OCR0A: case R_OCR0B:
+    case R_TIFR0: case R_TIFR1: case R_TIFR2: case R_TIFR3: case R_TIFR4: case R_TIFR5:
+    case R_PCIFR: case R_EIFR: case R_EIMSK: case R_SMCR: case R_MCUSR:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// タイマー制御レジスタの番号からタイマー番号と種類を得る
+bool timerReg(const uint8_t id, uint8_t *n, uint8_t *kind) {
+  static const uint8_t BASE[4] = { R_TCCR1A, R_TCCR3A, R_TCCR4A, R_TCCR5A };
+  static const uint8_t NUM[4] = { 1, 3, 4, 5 };
+  for (int i = 0; i < 4; i++) {
+    if (id >= BASE[i] && id < BASE[i] + 5) {
+      *n = NUM[i];
+      *kind = id - BASE[i];
+      return true;
+    }
+  }
+  switch (id) {
+    case R_TCCR0A: *n = 0; *kind = 0; return true;
+    case R_TCCR0B: *n = 0; *kind = 1; return true;
+    case R_TIMSK0: *n = 0; *kind = 3; return true;
+    case R_TIFR0: *n = 0; *kind = 4; return true;
+    case R_TCCR2A: *n = 2; *kind = 0; return true;
+    case R_TCCR2B: *n = 2; *kind = 1; return true;
+    case R_TIMSK2: *n = 2; *kind = 3; return true;
+    case R_TIFR2: *n = 2; *kind = 4; return true;
+    default: return false;
+  }
+}
+
+void ocrWrite(const uint8_t n, const uint8_t ch, const uint16_t v) {
+  Timer& t = g.timers[n];
+  if (n == 2 || n == 4) barIntegrate(g.now);
+  timerSync(n, g.now);
+  t.ocr_buf[ch] = v;
+  if (!buffered(n) || !prescale(n)) t.ocr[ch] = v;
+}
+
+} // namespace
+
+uint8_t readReg8(const uint8_t id) {
+  charge(ioSpace(id) ? 1 : 2);
+  if (id <= R_PORTL) {
+    const uint8_t p = id / 3;
+    switch (id % 3) {
+      case 0: return levels(p);
+      case 1: return g.ports[p].ddr;
+      default: return g.ports[p].port;
+    }
+  }
+  uint8_t n, kind;
+  if (timerReg(id, &n, &kind)) {
+    const Timer& t = g.timers[n];
+    switch (kind) {
+      case 0: return t.a;
+      case 1: return t.b;
+      case 2: return t.c;
+      case 3: return t.timsk;
+      default: return t.tifr;
+    }
+  }
+  switch (id) {
+    case R_SREG: return (uint8_t) ((g.regs[R_SREG] & 0x7F) | (g.ie ? 0x80 : 0));
+    case R_TCNT0: timerSync(0, g.now); return (uint8_t) countValue(0);
+    case R_TCNT2: timerSync(2, g.now); return (uint8_t) countValue(2);
+    case R_OCR0A: return (uint8_t) g.timers[0].ocr_buf[0];
+    case R_OCR0B: return (uint8_t) g.timers[0].ocr_buf[1];
+    case R_OCR2A: return (uint8_t) g.timers[2].ocr_buf[0];
+    case R_OCR2B: return (uint8_t) g.timers[2].ocr_buf[1];
+    case R_ADCSRA: return (uint8_t) ((g.regs[R_ADCSRA] & ~0x40) | (g.adc_busy ? 0x40 : 0));
+    case R_ADCL: return (uint8_t) g.adc_result;
+    case R_ADCH: return (uint8_t) (g.adc_result >> 8);
+    case R_UCSR0A: return (uint8_t) (g.tx_count < sizeof(g.tx) - 1 ? 0x20 : 0) | (g.rx_count ? 0x80 : 0);
+    default: return g.regs[id];
+  }
+}
+
+void writeReg8(const uint8_t id, const uint8_t v) {
+  g.horizon_ok = false;
+  if (id <= R_PORTL) {
+    const uint8_t p = id / 3;
+    Port& port = g.ports[p];
+    switch (id % 3) {
+      case 0: portWrite(p, port.port ^ v, port.ddr); break;
+      case 1: portWrite(p, port.port, v); break;
+      default: portWrite(p, v, port.ddr); break;
+    }
+    charge(ioSpace(id) ? 1 : 2);
+    return;
+  }
+  uint8_t n, kind;
+  if (timerReg(id, &n, &kind)) {
+    Timer& t = g.timers[n];
+    if (n == 2 || n == 4) barIntegrate(g.now);
+    timerSync(n, g.now);
+    // 動作モードが変わっても値は引き継ぐ
+    const uint16_t value = countValue(n);
+    switch (kind) {
+      case 0: t.a = v; break;
+      case 1: t.b = v; t.t_ref = g.now; break;
+      case 2: t.c = v; break;
+      case 3: t.timsk = v; break;
+      default: t.tifr &= ~v; break;
+    }
+    if (kind <= 1) t.cnt = value;
+    if (kind <= 1 && !buffered(n)) memcpy(t.ocr, t.ocr_buf, sizeof(t.ocr));
+    charge(ioSpace(id) ? 1 : 2);
+    return;
+  }
+  switch (id) {
+    case R_SREG:
+      g.regs[R_SREG] = v & 0x7F;
+      g.ie = v & 0x80;
+      break;
+    case R_TCNT0: timerSync(0, g.now); g.timers[0].cnt = v; break;
+    case R_TCNT2: timerSync(2, g.now); g.timers[2].cnt = v; break;
+    case R_OCR0A: ocrWrite(0, 0, v); break;
+    case R_OCR0B: ocrWrite(0, 1, v); break;
+    case R_OCR2A: ocrWrite(2, 0, v); break;
+    case R_OCR2B: ocrWrite(2, 1, v); break;
+    case R_ADCSRA: {
+      const uint8_t old = g.regs[R_ADCSRA];
+      uint8_t next = (uint8_t) ((v & ~0x50) | (old & 0x10));
+      if (v & 0x10) next &= ~0x10;
+      if (!(old & 0x80) && (v & 0x80)) g.adc_first = true;
+      g.regs[R_ADCSRA] = next;
+      if (!(v & 0x80)) g.adc_busy = false;
+      else if ((v & 0x40) && !g.adc_busy) adcStart(g.now);
+      break;
+    }
+    case R_PCIFR: g.regs[R_PCIFR] &= ~v; break;
+    case R_EIFR: g.regs[R_EIFR] &= ~v; break;
+    case R_UDR0: serialWrite(v); return;
+    default: g.regs[id] = v; break;
+  }
+  charge(ioSpace(id) ? 1 : 2);
+}
+
+uint16_t readReg16(const uint8_t id) {
+  charge(4);
+  if (id < R_ADCW) {
+    static const uint8_t NUM[4] = { 1, 3, 4, 5 };
+    const uint8_t n = NUM[id / 5];
+    Timer& t = g.timers[n];
+    switch (id % 5) {
+      case 0: timerSync(n, g.now); return countValue(n);
+      case 1: return t.ocr_buf[0];
+      case 2: return t.ocr_buf[1];
+      case 3: return t.ocr_buf[2];
+      default: return t.icr;
+    }
+  }
+  if (id == R_ADCW) return g.adc_result;
+  return 0;
+}
+
+void writeReg16(const uint8_t id, const uint16_t v) {
+  g.horizon_ok = false;
+  if (id < R_ADCW) {
+    static const uint8_t NUM[4] = { 1, 3, 4, 5 };
+    const uint8_t n = NUM[id / 5];
+    Timer& t = g.timers[n];
+    switch (id % 5) {
+      case 0: timerSync(n, g.now); t.cnt = v; break;
+      case 1: ocrWrite(n, 0, v); break;
+      case 2: ocrWrite(n, 1, v); break;
+      case 3: ocrWrite(n, 2, v); break;
+      default:
+        if (n == 4) barIntegrate(g.now);
+        timerSync(n, g.now);
+        t.icr = v;
+        break;
+    }
+  }
+  charge(4);
+}
+
+} // namespace sim
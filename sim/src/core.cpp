@@ -0,0 +1,248 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// Arduino コア (wiring.c / wiring_digital.c / wiring_analog.c / wiring_shift.c 相当)
+// 実機の関数と同じ順序でレジスタを操作し、おおよそのサイクル数を加算する。
+
+#include "Arduino.h"
+#include "sim/board.h"
+
+namespace {
+
+// 関数ごとのおおよそのコスト (AVR コアの命令列から見積もった値)
+const uint32_t DIGITAL_WRITE_CYCLES = 48;
+const uint32_t DIGITAL_READ_CYCLES = 44;
+const uint32_t TURN_OFF_PWM_CYCLES = 16;
+const uint32_t PIN_MODE_CYCLES = 56;
+const uint32_t ANALOG_READ_CYCLES = 1664 + 96;
+const uint32_t MILLIS_CYCLES = 30;
+const uint32_t MICROS_CYCLES = 44;
+const uint32_t MAP_CYCLES = 180;
+
+struct PinInfo { sim::Reg8 *port; sim::Reg8 *ddr; sim::Reg8 *in; uint8_t mask; uint8_t timer; };
+
+enum : uint8_t { NOT_ON_TIMER, T0A, T0B, T1A, T1B, T1C, T2A, T2B, T3A, T3B, T3C, T4A, T4B, T4C, T5A, T5B, T5C };
+
+#define PORTDEF(X, b, t) { &PORT##X, &DDR##X, &PIN##X, (uint8_t) (1 << (b)), t }
+const PinInfo PINS[NUM_DIGITAL_PINS] = {
+  PORTDEF(E, 0, 0), PORTDEF(E, 1, 0), PORTDEF(E, 4, T3B), PORTDEF(E, 5, T3C), PORTDEF(G, 5, T0B),
+  PORTDEF(E, 3, T3A), PORTDEF(H, 3, T4A), PORTDEF(H, 4, T4B), PORTDEF(H, 5, T4C), PORTDEF(H, 6, T2B),
+  PORTDEF(B, 4, T2A), PORTDEF(B, 5, T1A), PORTDEF(B, 6, T1B), PORTDEF(B, 7, T0A), PORTDEF(J, 1, 0),
+  PORTDEF(J, 0, 0), PORTDEF(H, 1, 0), PORTDEF(H, 0, 0), PORTDEF(D, 3, 0), PORTDEF(D, 2, 0),
+  PORTDEF(D, 1, 0), PORTDEF(D, 0, 0), PORTDEF(A, 0, 0), PORTDEF(A, 1, 0), PORTDEF(A, 2, 0),
+  PORTDEF(A, 3, 0), PORTDEF(A, 4, 0), PORTDEF(A, 5, 0), PORTDEF(A, 6, 0), PORTDEF(A, 7, 0),
+  PORTDEF(C, 7, 0), PORTDEF(C, 6, 0), PORTDEF(C, 5, 0), PORTDEF(C, 4, 0), PORTDEF(C, 3, 0),
+  PORTDEF(C, 2, 0), PORTDEF(C, 1, 0), PORTDEF(C, 0, 0), PORTDEF(D, 7, 0), PORTDEF(G, 2, 0),
+  PORTDEF(G, 1, 0), PORTDEF(G, 0, 0), PORTDEF(L, 7, 0), PORTDEF(L, 6, 0), PORTDEF(L, 5, T5C),
+  PORTDEF(L, 4, T5B), PORTDEF(L, 3, T5A), PORTDEF(L, 2, 0), PORTDEF(L, 1, 0), PORTDEF(L, 0, 0),
+  PORTDEF(B, 3, 0), PORTDEF(B, 2, 0), PORTDEF(B, 1, 0), PORTDEF(B, 0, 0), PORTDEF(F, 0, 0),
+  PORTDEF(F, 1, 0), PORTDEF(F, 2, 0), PORTDEF(F, 3, 0), PORTDEF(F, 4, 0), PORTDEF(F, 5, 0),
+  PORTDEF(F, 6, 0), PORTDEF(F, 7, 0), PORTDEF(K, 0, 0), PORTDEF(K, 1, 0), PORTDEF(K, 2, 0),
+  PORTDEF(K, 3, 0), PORTDEF(K, 4, 0), PORTDEF(K, 5, 0), PORTDEF(K, 6, 0), PORTDEF(K, 7, 0)
+};
+#undef PORTDEF
+
+struct TimerOut { sim::Reg8 *tccra; uint8_t com1; sim::Reg8 *ocr8; sim::Reg16 *ocr16; };
+
+TimerOut timerOut(const uint8_t timer) {
+  switch (timer) {
+    case T0A: return { &TCCR0A, COM0A1, &OCR0A, nullptr };
+    case T0B: return { &TCCR0A, COM0B1, &OCR0B, nullptr };
+    case T1A: return { &TCCR1A, COM1A1, nullptr, &OCR1A };
+    case T1B: return { &TCCR1A, COM1B1, nullptr, &OCR1B };
+    case T1C: return { &TCCR1A, COM1C1, nullptr, &OCR1C };
+    case T2A: return { &TCCR2A, COM2A1, &OCR2A, nullptr };
+    case T2B: return { &TCCR2A, COM2B1, &OCR2B, nullptr };
+    case T3A: return { &TCCR3A, COM3A1, nullptr, &OCR3A };
+    case T3B: return { &TCCR3A, COM3B1, nullptr, &OCR3B };
+    case T3C: return { &TCCR3A, COM3C1, nullptr, &OCR3C };
+    case T4A: return { &TCCR4A, COM4A1, nullptr, &OCR4A };
+    case T4B: return { &TCCR4A, COM4B1, nullptr, &OCR4B };
+    case T4C: return { &TCCR4A, COM4C1, nullptr, &OCR4C };
+    case T5A: return { &TCCR5A, COM5A1, nullptr, &OCR5A };
+    case T5B: return { &TCCR5A, COM5B1, nullptr, &OCR5B };
+    default: return { &TCCR5A, COM5C1, nullptr, &OCR5C };
+  }
+}
+
+void turnOffPWM(const uint8_t timer) {
+  const TimerOut t = timerOut(timer);
+  *t.tccra &= (uint8_t) ~_BV(t.com1);
+}
+
+unsigned long next_random = 1;
+
+} // namespace
+
+void init(void) {
+  sim::reset();
+}
+
+void pinMode(const uint8_t pin, const uint8_t mode) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  sim::charge(PIN_MODE_CYCLES - 6);
+  const PinInfo& p = PINS[pin];
+  const uint8_t sreg = SREG;
+  cli();
+  if (mode == INPUT) {
+    *p.ddr &= (uint8_t) ~p.mask;
+    *p.port &= (uint8_t) ~p.mask;
+  } else if (mode == INPUT_PULLUP) {
+    *p.ddr &= (uint8_t) ~p.mask;
+    *p.port |= p.mask;
+  } else {
+    *p.ddr |= p.mask;
+  }
+  SREG = sreg;
+}
+
+void digitalWrite(const uint8_t pin, const uint8_t val) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  const PinInfo& p = PINS[pin];
+  sim::charge(DIGITAL_WRITE_CYCLES - 6);
+  if (p.timer != NOT_ON_TIMER) {
+    sim::charge(TURN_OFF_PWM_CYCLES);
+    turnOffPWM(p.timer);
+  }
+  const uint8_t sreg = SREG;
+  cli();
+  if (val == LOW) *p.port &= (uint8_t) ~p.mask;
+  else *p.port |= p.mask;
+  SREG = sreg;
+}
+
+int digitalRead(const uint8_t pin) {
+  if (pin >= NUM_DIGITAL_PINS) return LOW;
+  const PinInfo& p = PINS[pin];
+  sim::charge(DIGITAL_READ_CYCLES - 1);
+  if (p.timer != NOT_ON_TIMER) {
+    sim::charge(TURN_OFF_PWM_CYCLES);
+    turnOffPWM(p.timer);
+  }
+  return (*p.in & p.mask) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) {
+  if (pin >= 54) pin -= 54;
+  // 変換中は割り込みを受け付けつつ待つ
+  sim::charge(ANALOG_READ_CYCLES);
+  return sim::analogValue(pin & 15);
+}
+
+void analogReference(const uint8_t mode) {
+  (void) mode;
+}
+
+void analogWrite(const uint8_t pin, const int val) {
+  pinMode(pin, OUTPUT);
+  if (pin >= NUM_DIGITAL_PINS) return;
+  const PinInfo& p = PINS[pin];
+  if (val == 0 || p.timer == NOT_ON_TIMER) {
+    digitalWrite(pin, val < 128 ? LOW : HIGH);
+    return;
+  }
+  if (val == 255) {
+    digitalWrite(pin, HIGH);
+    return;
+  }
+  const TimerOut t = timerOut(p.timer);
+  *t.tccra |= _BV(t.com1);
+  if (t.ocr8) *t.ocr8 = (uint8_t) val;
+  else *t.ocr16 = (uint16_t) val;
+}
+
+unsigned long millis(void) {
+  sim::charge(MILLIS_CYCLES);
+  return (unsigned long) (sim::now() / sim::CYCLES_PER_MS);
+}
+
+unsigned long micros(void) {
+  sim::charge(MICROS_CYCLES);
+  // 実機と同じく 4us 単位
+  return (unsigned long) (sim::now() / (4 * sim::CYCLES_PER_US) * 4);
+}
+
+void delay(const unsigned long ms) {
+  sim::charge(MICROS_CYCLES);
+  sim::waitUntil(sim::now() + (uint64_t) ms * sim::CYCLES_PER_MS);
+}
+
+void delayMicroseconds(const unsigned int us) {
+  if (us > 1) sim::charge((uint32_t) us * sim::CYCLES_PER_US - 8);
+}
+
+unsigned long pulseIn(const uint8_t pin, const uint8_t state, const unsigned long timeout) {
+  const unsigned long start = micros();
+  while (digitalRead(pin) == state)
+    if (micros() - start >= timeout) return 0;
+  while (digitalRead(pin) != state)
+    if (micros() - start >= timeout) return 0;
+  const unsigned long begin = micros();
+  while (digitalRead(pin) == state)
+    if (micros() - start >= timeout) return 0;
+  return micros() - begin;
+}
+
+void shiftOut(const uint8_t dataPin, const uint8_t clockPin, const uint8_t bitOrder, uint8_t val) {
+  for (uint8_t i = 0; i < 8; i++) {
+    if (bitOrder == LSBFIRST) {
+      digitalWrite(dataPin, val & 1);
+      val >>= 1;
+    } else {
+      digitalWrite(dataPin, (val & 128) != 0);
+      val <<= 1;
+    }
+    digitalWrite(clockPin, HIGH);
+    digitalWrite(clockPin, LOW);
+  }
+}
+
+uint8_t shiftIn(const uint8_t dataPin, const uint8_t clockPin, const uint8_t bitOrder) {
+  uint8_t value = 0;
+  for (uint8_t i = 0; i < 8; ++i) {
+    digitalWrite(clockPin, HIGH);
+    if (bitOrder == LSBFIRST) value |= digitalRead(dataPin) << i;
+    else value |= digitalRead(dataPin) << (7 - i);
+    digitalWrite(clockPin, LOW);
+  }
+  return value;
+}
+
+long map(const long x, const long in_min, const long in_max, const long out_min, const long out_max) {
+  sim::charge(MAP_CYCLES);
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+long random(const long howbig) {
+  if (howbig == 0) return 0;
+  next_random = next_random * 1103515245UL + 12345UL;
+  return (long) ((next_random >> 16) % (unsigned long) howbig);
+}
+
+long random(const long howsmall, const long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(const unsigned long seed) {
+  if (seed != 0) next_random = seed;
+}
+
+void yield(void) {
+}
+
+// millis() 用の Timer0 溢れ割り込み (実機のコアが占有する)
+ISR(TIMER0_OVF_vect) {
+  sim::charge(70);
+}
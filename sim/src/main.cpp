@@ -0,0 +1,347 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 仮想ボードでスケッチを実行する
+//
+//   inspector_sim [--seconds 秒] [--script ファイル] [--repeat 回数] [--vcd ファイル]
+//                 [--serial-in ファイル] [--serial-out ファイル|-] [--mode-pin latch|enable]
+//                 [--photo-blades 枚数] [--adc-noise LSB] [--seed 値] [--pty リンク] [--realtime] [--quiet]
+//
+// 入力スクリプトは 1 行に 1 つ、"時刻[ms] 名前 値" の形式で書く。
+//   100 toggle 1        トグルを上げる (1 = 上向き)
+//   200 press RL 50     タクト RL を 50ms 押す (TL, TR, LL, LR, RL, RR)
+//   300 photo 1         フォトインタラプタを遮光する
+//   300 clock photo 20 5 100   周期 20ms・遮光 5ms を 100 回
+//   400 pot 512         半固定抵抗 (0〜1023)
+//   400 joy_x 900       ジョイスティック (joy_x, joy_y)
+//   500 D42 0           ピン番号で直接レベルを指定
+//   600 load 0.3        DC モーターの負荷 (0〜1)
+//   600 blades 2        フォトインタラプタを DC モーターの羽根と連動させる
+// 終了時に実行結果を JSON で出力する。
+//
+// --serial-in のファイルの中身は起動直後にシリアルで受信する。(例: "telemetry on" の行でテレメトリーを流す)
+// --pty を付けるとシリアルを疑似端末につなぎ、その端末へのシンボリックリンクを作る。
+// ホストの道具から実機と同じように読み書きできる。（--realtime で実時間に合わせて進める）
+
+#include "Arduino.h"
+#include "sim/board.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+struct Named { const char *name; uint8_t pin; bool active; };
+// 論理値 1 の時のピンレベル
+const Named DIGITAL[] = {
+  { "toggle", 48, true }, { "photo", 42, false },
+  { "TL", 44, true }, { "TR", 45, true }, { "LL", 49, true }, { "LR", 51, true }, { "RL", 50, true }, { "RR", 52, true }
+};
+struct Analog { const char *name; uint8_t channel; };
+const Analog ANALOG[] = { { "pot", 15 }, { "joy_x", 1 }, { "joy_y", 2 } };
+
+uint64_t ms(const double t) {
+  return (uint64_t) (t * (double) sim::CYCLES_PER_MS + 0.5);
+}
+
+bool digital(const char *name, uint8_t *pin, bool *active) {
+  for (const Named& d : DIGITAL) {
+    if (!strcmp(d.name, name)) {
+      *pin = d.pin;
+      *active = d.active;
+      return true;
+    }
+  }
+  if (name[0] == 'D' && name[1]) {
+    *pin = (uint8_t) atoi(name + 1);
+    *active = true;
+    return *pin < NUM_DIGITAL_PINS;
+  }
+  return false;
+}
+
+bool analog(const char *name, uint8_t *channel) {
+  for (const Analog& a : ANALOG) {
+    if (!strcmp(a.name, name)) {
+      *channel = a.channel;
+      return true;
+    }
+  }
+  if (name[0] == 'A' && name[1]) {
+    *channel = (uint8_t) atoi(name + 1);
+    return *channel < 16;
+  }
+  return false;
+}
+
+// スクリプトを読み込み、終了時刻 [ms] を返す
+double loadScript(const char *path, const double offset) {
+  FILE *fp = fopen(path, "r");
+  if (!fp) {
+    perror(path);
+    exit(2);
+  }
+  char line[256];
+  double last = 0.0;
+  int lineno = 0;
+  while (fgets(line, sizeof(line), fp)) {
+    lineno++;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+    double t;
+    char name[32], arg1[32] = "", arg2[32] = "", arg3[32] = "", arg4[32] = "";
+    const int n = sscanf(line, "%lf %31s %31s %31s %31s %31s", &t, name, arg1, arg2, arg3, arg4);
+    if (n <= 0) continue;
+    if (n < 3) {
+      fprintf(stderr, "%s:%d: syntax error\n", path, lineno);
+      exit(2);
+    }
+    const double at = offset + t;
+    if (t > last) last = t;
+    uint8_t pin, channel;
+    bool active;
+    if (!strcmp(name, "press") && n >= 4 && digital(arg1, &pin, &active)) {
+      const double len = atof(arg2);
+      sim::scheduleInput(ms(at), sim::IN_PIN, pin, active);
+      sim::scheduleInput(ms(at + len), sim::IN_PIN, pin, !active);
+      if (t + len > last) last = t + len;
+    } else if (!strcmp(name, "clock") && n >= 6 && digital(arg1, &pin, &active)) {
+      const double per = atof(arg2), high = atof(arg3);
+      const int count = atoi(arg4);
+      for (int i = 0; i < count; i++) {
+        sim::scheduleInput(ms(at + i * per), sim::IN_PIN, pin, active);
+        sim::scheduleInput(ms(at + i * per + high), sim::IN_PIN, pin, !active);
+      }
+      if (t + count * per > last) last = t + count * per;
+    } else if (!strcmp(name, "load")) {
+      sim::scheduleInput(ms(at), sim::IN_LOAD, 0, (uint16_t) (atof(arg1) * 1000.0));
+    } else if (!strcmp(name, "blades")) {
+      sim::scheduleInput(ms(at), sim::IN_COUPLE, 0, (uint16_t) atoi(arg1));
+    } else if (digital(name, &pin, &active)) {
+      const bool on = atoi(arg1) != 0;
+      sim::scheduleInput(ms(at), sim::IN_PIN, pin, on ? active : !active);
+    } else if (analog(name, &channel)) {
+      sim::scheduleInput(ms(at), sim::IN_ANALOG, channel, (uint16_t) atoi(arg1));
+    } else {
+      fprintf(stderr, "%s:%d: unknown input '%s'\n", path, lineno, name);
+      exit(2);
+    }
+  }
+  fclose(fp);
+  return last;
+}
+
+FILE *serial_out = nullptr;
+
+void toFile(const uint8_t c, void *ctx) {
+  (void) ctx;
+  fputc(c, serial_out);
+}
+
+double hostSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 疑似端末を作って link からリンクし、主側の fd を返す (従側は生モードで開いたままにする)
+int openPty(const char *link, int *slave) {
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) || unlockpt(master)) return -1;
+  const char *name = ptsname(master);
+  *slave = name ? open(name, O_RDWR | O_NOCTTY) : -1;
+  if (*slave < 0) return -1;
+  // 従側の行編集とエコーを止めないと、送った値が受信に戻ってくる
+  struct termios tio;
+  tcgetattr(*slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(*slave, TCSANOW, &tio);
+  // 読む相手がいない間は実機と同じく捨てる
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  unlink(link);
+  if (symlink(name, link)) return -1;
+  return master;
+}
+
+void usage() {
+  fprintf(stderr,
+          "usage: inspector_sim [--seconds S] [--script FILE] [--repeat N] [--vcd FILE]\n"
+          "                     [--serial-in FILE] [--serial-out FILE|-] [--mode-pin latch|enable]\n"
+          "                     [--photo-blades N] [--adc-noise LSB] [--seed N] [--pty LINK] [--realtime] [--quiet]\n");
+  exit(2);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  double seconds = 10.0;
+  const char *script = nullptr;
+  const char *vcd = nullptr;
+  const char *in = nullptr;
+  const char *out = nullptr;
+  const char *pty = nullptr;
+  int repeat = 1;
+  bool quiet = false;
+  bool realtime = false;
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    const bool has = i + 1 < argc;
+    if (!strcmp(a, "--seconds") && has) seconds = atof(argv[++i]);
+    else if (!strcmp(a, "--script") && has) script = argv[++i];
+    else if (!strcmp(a, "--repeat") && has) repeat = atoi(argv[++i]);
+    else if (!strcmp(a, "--vcd") && has) vcd = argv[++i];
+    else if (!strcmp(a, "--serial-in") && has) in = argv[++i];
+    else if (!strcmp(a, "--serial-out") && has) out = argv[++i];
+    else if (!strcmp(a, "--mode-pin") && has) sim::options().mode_latch = strcmp(argv[++i], "enable") != 0;
+    else if (!strcmp(a, "--photo-blades") && has) sim::options().photo_blades = (uint8_t) atoi(argv[++i]);
+    else if (!strcmp(a, "--adc-noise") && has) sim::options().adc_noise = (uint8_t) atoi(argv[++i]);
+    else if (!strcmp(a, "--seed") && has) sim::options().seed = (uint32_t) strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(a, "--pty") && has) pty = argv[++i];
+    else if (!strcmp(a, "--realtime")) realtime = true;
+    else if (!strcmp(a, "--quiet")) quiet = true;
+    else usage();
+  }
+  if (script) {
+    double offset = 0.0;
+    for (int r = 0; r < repeat; r++) offset += loadScript(script, offset) + 1.0;
+    if (repeat > 1 && offset / 1000.0 > seconds) seconds = offset / 1000.0;
+  }
+  FILE *vcd_fp = nullptr;
+  if (vcd) {
+    vcd_fp = fopen(vcd, "w");
+    if (!vcd_fp) {
+      perror(vcd);
+      return 2;
+    }
+  }
+  if (out) {
+    serial_out = strcmp(out, "-") ? fopen(out, "wb") : stdout;
+    if (!serial_out) {
+      perror(out);
+      return 2;
+    }
+    sim::serialSink(toFile, nullptr);
+  }
+  int in_fd = -1;
+  if (in) {
+    in_fd = open(in, O_RDONLY);
+    if (in_fd < 0) {
+      perror(in);
+      return 2;
+    }
+    sim::serialAttach(in_fd, -1);
+  }
+  int pty_master = -1, pty_slave = -1;
+  if (pty) {
+    pty_master = openPty(pty, &pty_slave);
+    if (pty_master < 0) {
+      perror(pty);
+      return 2;
+    }
+    sim::serialAttach(pty_master, pty_master);
+  }
+
+  const double host_start = hostSeconds();
+  init();
+  sim::traceOpen(vcd_fp);
+  setup();
+  sim::resetStats();
+  const uint64_t start = sim::now();
+  const uint64_t end = start + (uint64_t) (seconds * 1000.0) * sim::CYCLES_PER_MS;
+  uint64_t loops = 0, loop_max = 0;
+  // 実時間に合わせる時の次の確認時刻
+  uint64_t pace = start;
+  const double pace_host = hostSeconds();
+  while (sim::now() < end) {
+    const uint64_t t = sim::now();
+    loop();
+    const uint64_t d = sim::now() - t;
+    if (d > loop_max) loop_max = d;
+    loops++;
+    if (realtime && sim::now() >= pace) {
+      pace = sim::now() + sim::CYCLES_PER_MS;
+      const double ahead = (double) (sim::now() - start) / (sim::CYCLES_PER_MS * 1000) - (hostSeconds() - pace_host);
+      if (ahead > 0.0) usleep((useconds_t) (ahead * 1e6));
+    }
+  }
+  sim::flushStats();
+  sim::traceClose();
+  if (vcd_fp) fclose(vcd_fp);
+  if (serial_out && serial_out != stdout) fclose(serial_out);
+  if (in_fd >= 0) close(in_fd);
+  if (pty) {
+    close(pty_slave);
+    close(pty_master);
+    unlink(pty);
+  }
+  const double host = hostSeconds() - host_start;
+  if (quiet) return 0;
+
+  const sim::Stats& s = sim::stats();
+  const double span = (double) (sim::now() - s.since);
+  const double sim_s = span / (double) (sim::CYCLES_PER_MS * 1000);
+  printf("{\n");
+  printf("  \"sim_seconds\": %.6f,\n", sim_s);
+  printf("  \"host_seconds\": %.6f,\n", host);
+  printf("  \"speedup\": %.1f,\n", host > 0 ? sim_s / host : 0.0);
+  printf("  \"loops\": %llu,\n", (unsigned long long) loops);
+  printf("  \"loops_per_second\": %.1f,\n", sim_s > 0 ? loops / sim_s : 0.0);
+  printf("  \"loop_us_mean\": %.2f,\n", loops ? span / loops / sim::CYCLES_PER_US : 0.0);
+  printf("  \"loop_us_max\": %.2f,\n", (double) loop_max / sim::CYCLES_PER_US);
+  printf("  \"isr_load\": %.4f,\n", span > 0 ? s.isr_cycles / span : 0.0);
+  printf("  \"matrix\": {\n    \"latches\": %u,\n    \"duty\": [", s.matrix_latches);
+  // 行ごとに、左の列 (7) から右の列 (0) の順
+  for (int r = 0; r < 8; r++) {
+    printf("%s\n      \"", r ? "," : "");
+    for (int c = 7; c >= 0; c--) {
+      const double d = span > 0 ? s.matrix_on[c][r] / span : 0.0;
+      printf("%c", d <= 0.0 ? '.' : "123456789#"[d * 80.0 >= 9.0 ? 9 : (int) (d * 80.0)]);
+    }
+    printf("\"");
+  }
+  printf("\n    ]\n  },\n");
+  printf("  \"seg\": { \"duty\": [");
+  for (int i = 0; i < 8; i++) printf("%s%.3f", i ? ", " : "", span > 0 ? s.seg_on[i] / span : 0.0);
+  printf("], \"seg_mode_edges\": %u, \"mode_edges\": %u },\n", s.seg_mode_edges, s.mode_edges);
+  printf("  \"bar\": [");
+  for (int i = 0; i < 10; i++) {
+    printf("%s\n    [%.3f, %.3f, %.3f, %.3f]", i ? "," : "", s.bar_on[i][0] / span, s.bar_on[i][1] / span,
+           s.bar_on[i][2] / span, s.bar_on[i][3] / span);
+  }
+  printf("\n  ],\n");
+  printf("  \"stepper\": { \"position\": %d, \"steps\": %u, \"skipped\": %u },\n", s.stepper_position, s.stepper_steps,
+         s.stepper_skipped);
+  printf("  \"dc\": { \"drive\": %u, \"rpm\": %.1f, \"revs\": %.2f },\n", s.motor_drive, s.motor_rpm, s.motor_revs);
+  printf("  \"servo\": { \"us\": %u, \"writes\": %u, \"changes\": %u },\n", s.servo_us, s.servo_writes, s.servo_changes);
+  printf("  \"buzzer\": { \"starts\": %u, \"on_seconds\": %.3f, \"hz\": %.1f },\n", s.buzzer_starts,
+         s.buzzer_on / (double) (sim::CYCLES_PER_MS * 1000), s.buzzer_hz);
+  printf("  \"photo_edges\": %u,\n", s.photo_edges);
+  printf("  \"serial\": { \"tx\": %llu, \"rx\": %llu, \"blocked\": %u },\n", (unsigned long long) s.serial_tx,
+         (unsigned long long) s.serial_rx, s.serial_blocked);
+  printf("  \"isr\": {");
+  bool first = true;
+  for (int v = 1; v < 64; v++) {
+    if (!s.isr_calls[v]) continue;
+    printf("%s \"%d\": %u", first ? "" : ",", v, s.isr_calls[v]);
+    first = false;
+  }
+  printf(" }\n}\n");
+  (void) start;
+  return 0;
+}
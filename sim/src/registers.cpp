@@ -0,0 +1,136 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// <avr/io.h> のレジスタの実体
+
+#include "avr/io.h"
+
+sim::Reg8 PINA(sim::R_PINA);
+sim::Reg8 DDRA(sim::R_DDRA);
+sim::Reg8 PORTA(sim::R_PORTA);
+sim::Reg8 PINB(sim::R_PINB);
+sim::Reg8 DDRB(sim::R_DDRB);
+sim::Reg8 PORTB(sim::R_PORTB);
+sim::Reg8 PINC(sim::R_PINC);
+sim::Reg8 DDRC(sim::R_DDRC);
+sim::Reg8 PORTC(sim::R_PORTC);
+sim::Reg8 PIND(sim::R_PIND);
+sim::Reg8 DDRD(sim::R_DDRD);
+sim::Reg8 PORTD(sim::R_PORTD);
+sim::Reg8 PINE(sim::R_PINE);
+sim::Reg8 DDRE(sim::R_DDRE);
+sim::Reg8 PORTE(sim::R_PORTE);
+sim::Reg8 PINF(sim::R_PINF);
+sim::Reg8 DDRF(sim::R_DDRF);
+sim::Reg8 PORTF(sim::R_PORTF);
+sim::Reg8 PING(sim::R_PING);
+sim::Reg8 DDRG(sim::R_DDRG);
+sim::Reg8 PORTG(sim::R_PORTG);
+sim::Reg8 PINH(sim::R_PINH);
+sim::Reg8 DDRH(sim::R_DDRH);
+sim::Reg8 PORTH(sim::R_PORTH);
+sim::Reg8 PINJ(sim::R_PINJ);
+sim::Reg8 DDRJ(sim::R_DDRJ);
+sim::Reg8 PORTJ(sim::R_PORTJ);
+sim::Reg8 PINK(sim::R_PINK);
+sim::Reg8 DDRK(sim::R_DDRK);
+sim::Reg8 PORTK(sim::R_PORTK);
+sim::Reg8 PINL(sim::R_PINL);
+sim::Reg8 DDRL(sim::R_DDRL);
+sim::Reg8 PORTL(sim::R_PORTL);
+sim::Reg8 SREG(sim::R_SREG);
+sim::Reg8 GPIOR0(sim::R_GPIOR0);
+sim::Reg8 GPIOR1(sim::R_GPIOR1);
+sim::Reg8 GPIOR2(sim::R_GPIOR2);
+sim::Reg8 TCCR0A(sim::R_TCCR0A);
+sim::Reg8 TCCR0B(sim::R_TCCR0B);
+sim::Reg8 TCNT0(sim::R_TCNT0);
+sim::Reg8 OCR0A(sim::R_OCR0A);
+sim::Reg8 OCR0B(sim::R_OCR0B);
+sim::Reg8 TIMSK0(sim::R_TIMSK0);
+sim::Reg8 TIFR0(sim::R_TIFR0);
+sim::Reg8 TCCR2A(sim::R_TCCR2A);
+sim::Reg8 TCCR2B(sim::R_TCCR2B);
+sim::Reg8 TCNT2(sim::R_TCNT2);
+sim::Reg8 OCR2A(sim::R_OCR2A);
+sim::Reg8 OCR2B(sim::R_OCR2B);
+sim::Reg8 TIMSK2(sim::R_TIMSK2);
+sim::Reg8 TIFR2(sim::R_TIFR2);
+sim::Reg8 ASSR(sim::R_ASSR);
+sim::Reg8 TCCR1A(sim::R_TCCR1A);
+sim::Reg8 TCCR1B(sim::R_TCCR1B);
+sim::Reg8 TCCR1C(sim::R_TCCR1C);
+sim::Reg8 TIMSK1(sim::R_TIMSK1);
+sim::Reg8 TIFR1(sim::R_TIFR1);
+sim::Reg8 TCCR3A(sim::R_TCCR3A);
+sim::Reg8 TCCR3B(sim::R_TCCR3B);
+sim::Reg8 TCCR3C(sim::R_TCCR3C);
+sim::Reg8 TIMSK3(sim::R_TIMSK3);
+sim::Reg8 TIFR3(sim::R_TIFR3);
+sim::Reg8 TCCR4A(sim::R_TCCR4A);
+sim::Reg8 TCCR4B(sim::R_TCCR4B);
+sim::Reg8 TCCR4C(sim::R_TCCR4C);
+sim::Reg8 TIMSK4(sim::R_TIMSK4);
+sim::Reg8 TIFR4(sim::R_TIFR4);
+sim::Reg8 TCCR5A(sim::R_TCCR5A);
+sim::Reg8 TCCR5B(sim::R_TCCR5B);
+sim::Reg8 TCCR5C(sim::R_TCCR5C);
+sim::Reg8 TIMSK5(sim::R_TIMSK5);
+sim::Reg8 TIFR5(sim::R_TIFR5);
+sim::Reg8 ADMUX(sim::R_ADMUX);
+sim::Reg8 ADCSRA(sim::R_ADCSRA);
+sim::Reg8 ADCSRB(sim::R_ADCSRB);
+sim::Reg8 ADCL(sim::R_ADCL);
+sim::Reg8 ADCH(sim::R_ADCH);
+sim::Reg8 DIDR0(sim::R_DIDR0);
+sim::Reg8 DIDR2(sim::R_DIDR2);
+sim::Reg8 PCICR(sim::R_PCICR);
+sim::Reg8 PCIFR(sim::R_PCIFR);
+sim::Reg8 PCMSK0(sim::R_PCMSK0);
+sim::Reg8 PCMSK1(sim::R_PCMSK1);
+sim::Reg8 PCMSK2(sim::R_PCMSK2);
+sim::Reg8 EICRA(sim::R_EICRA);
+sim::Reg8 EICRB(sim::R_EICRB);
+sim::Reg8 EIMSK(sim::R_EIMSK);
+sim::Reg8 EIFR(sim::R_EIFR);
+sim::Reg8 UCSR0A(sim::R_UCSR0A);
+sim::Reg8 UCSR0B(sim::R_UCSR0B);
+sim::Reg8 UCSR0C(sim::R_UCSR0C);
+sim::Reg8 UDR0(sim::R_UDR0);
+sim::Reg8 PRR0(sim::R_PRR0);
+sim::Reg8 PRR1(sim::R_PRR1);
+sim::Reg8 SMCR(sim::R_SMCR);
+sim::Reg8 MCUSR(sim::R_MCUSR);
+sim::Reg16 TCNT1(sim::R_TCNT1);
+sim::Reg16 OCR1A(sim::R_OCR1A);
+sim::Reg16 OCR1B(sim::R_OCR1B);
+sim::Reg16 OCR1C(sim::R_OCR1C);
+sim::Reg16 ICR1(sim::R_ICR1);
+sim::Reg16 TCNT3(sim::R_TCNT3);
+sim::Reg16 OCR3A(sim::R_OCR3A);
+sim::Reg16 OCR3B(sim::R_OCR3B);
+sim::Reg16 OCR3C(sim::R_OCR3C);
+sim::Reg16 ICR3(sim::R_ICR3);
+sim::Reg16 TCNT4(sim::R_TCNT4);
+sim::Reg16 OCR4A(sim::R_OCR4A);
+sim::Reg16 OCR4B(sim::R_OCR4B);
+sim::Reg16 OCR4C(sim::R_OCR4C);
+sim::Reg16 ICR4(sim::R_ICR4);
+sim::Reg16 TCNT5(sim::R_TCNT5);
+sim::Reg16 OCR5A(sim::R_OCR5A);
+sim::Reg16 OCR5B(sim::R_OCR5B);
+sim::Reg16 OCR5C(sim::R_OCR5C);
+sim::Reg16 ICR5(sim::R_ICR5);
+sim::Reg16 ADCW(sim::R_ADCW);
+sim::Reg16 UBRR0(sim::R_UBRR0);
@@ -0,0 +1,63 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// HardwareSerial (USART0)
+// 実機のコアと同じく USART0 の割り込みを占有する。
+
+#include "Arduino.h"
+#include "sim/board.h"
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(const unsigned long baud, const uint8_t config) {
+  (void) config;
+  sim::charge(80);
+  sim::serialBegin(baud);
+}
+
+void HardwareSerial::end() {
+  sim::serialEnd();
+}
+
+int HardwareSerial::available() {
+  return sim::serialAvailable();
+}
+
+int HardwareSerial::peek() {
+  return sim::serialPeek();
+}
+
+int HardwareSerial::read() {
+  return sim::serialRead();
+}
+
+int HardwareSerial::availableForWrite() {
+  return sim::serialAvailableForWrite();
+}
+
+void HardwareSerial::flush() {
+  sim::serialFlush();
+}
+
+size_t HardwareSerial::write(const uint8_t c) {
+  sim::serialWrite(c);
+  return 1;
+}
+
+// 実機では受信・送信バッファ空きの割り込みをコアが定義している
+ISR(USART0_RX_vect) {
+}
+
+ISR(USART0_UDRE_vect) {
+}
@@ -0,0 +1,130 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// Servo ライブラリ (1 台分)
+// 実機と同じく Timer5 の比較一致割り込みでパルスを出す。
+
+#include "Arduino.h"
+#include "Servo.h"
+#include "sim/board.h"
+
+namespace {
+
+// 0.5us 単位 (1/8 分周)
+inline uint16_t usToTicks(const int us) {
+  return (uint16_t) (us * 2);
+}
+
+volatile uint16_t pulse_ticks = usToTicks(DEFAULT_PULSE_WIDTH);
+volatile uint8_t servo_pin = 255;
+volatile uint8_t phase = 0;
+uint8_t servo_count = 0;
+
+} // namespace
+
+Servo::Servo() : servoIndex(INVALID_SERVO) {
+  this->min = 0;
+  this->max = 0;
+  if (servo_count < MAX_SERVOS) servoIndex = servo_count++;
+}
+
+uint8_t Servo::attach(const int pin) {
+  return attach(pin, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH);
+}
+
+uint8_t Servo::attach(const int pin, const int min_us, const int max_us) {
+  if (servoIndex != 0) return servoIndex;
+  pinMode((uint8_t) pin, OUTPUT);
+  servo_pin = (uint8_t) pin;
+  min = (int8_t) ((MIN_PULSE_WIDTH - min_us) / 4);
+  max = (int8_t) ((MAX_PULSE_WIDTH - max_us) / 4);
+  // Timer5 を通常モード・1/8 分周で占有
+  TCCR5A = 0;
+  TCCR5B = _BV(CS51);
+  TCNT5 = 0;
+  TIFR5 = _BV(OCF5A);
+  OCR5A = 10;
+  phase = 0;
+  TIMSK5 |= _BV(OCIE5A);
+  return servoIndex;
+}
+
+void Servo::detach() {
+  TIMSK5 &= (uint8_t) ~_BV(OCIE5A);
+  servo_pin = 255;
+}
+
+void Servo::write(int value) {
+  if (value < MIN_PULSE_WIDTH) {
+    if (value < 0) value = 0;
+    if (value > 180) value = 180;
+    value = map(value, 0, 180, MIN_PULSE_WIDTH - min * 4, MAX_PULSE_WIDTH - max * 4);
+  }
+  writeMicroseconds(value);
+}
+
+void Servo::writeMicroseconds(int value) {
+  sim::charge(40);
+  const int lo = MIN_PULSE_WIDTH - min * 4;
+  const int hi = MAX_PULSE_WIDTH - max * 4;
+  if (value < lo) value = lo;
+  if (value > hi) value = hi;
+  const uint8_t sreg = SREG;
+  cli();
+  pulse_ticks = usToTicks(value);
+  SREG = sreg;
+  sim::servoPulse(servo_pin, (uint16_t) value);
+}
+
+int Servo::read() {
+  return map(readMicroseconds() + 1, MIN_PULSE_WIDTH - min * 4, MAX_PULSE_WIDTH - max * 4, 0, 180);
+}
+
+int Servo::readMicroseconds() {
+  return pulse_ticks / 2;
+}
+
+bool Servo::attached() {
+  return servo_pin != 255;
+}
+
+// パルスの立ち上がり・立ち下がり・周期の終わり
+// 実機のライブラリは Mega では Timer5, 1, 3, 4 の比較一致 A を全て定義するので、ここでも同じベクタを持つ
+// (スケッチが同じベクタを使うと、実機と同じくリンクで重複になる)
+ISR(TIMER5_COMPA_vect) {
+  sim::charge(60);
+  switch (phase) {
+    case 0:
+      TCNT5 = 0;
+      if (servo_pin != 255) digitalWrite(servo_pin, HIGH);
+      OCR5A = pulse_ticks;
+      phase = 1;
+      break;
+    default:
+      if (servo_pin != 255) digitalWrite(servo_pin, LOW);
+      OCR5A = usToTicks(REFRESH_INTERVAL);
+      phase = 0;
+      break;
+  }
+}
+
+// 13 台目以降の分 (1 台分の実装では使わない)
+ISR(TIMER1_COMPA_vect) {
+}
+
+ISR(TIMER3_COMPA_vect) {
+}
+
+ISR(TIMER4_COMPA_vect) {
+}
@@ -0,0 +1,87 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// tone() / noTone() (Tone.cpp 相当)
+// 実機と同じく Timer2 の比較一致割り込みでピンを反転する。
+// スケッチが TIMER2_COMPA_vect を定義していると、実機と同様にリンクで衝突する。
+
+#include "Arduino.h"
+#include "sim/board.h"
+
+namespace {
+
+volatile long toggle_count = 0;
+volatile uint8_t tone_pin = 255;
+sim::Reg8 *tone_port = nullptr;
+uint8_t tone_mask = 0;
+
+} // namespace
+
+void tone(const uint8_t pin, const unsigned int frequency, const unsigned long duration) {
+  sim::charge(120);
+  if (tone_pin != pin) {
+    tone_pin = pin;
+    // CTC モード、出力比較ピンは使わない
+    TCCR2A = 0;
+    TCCR2B = 0;
+    TCCR2A |= _BV(WGM21);
+    TCCR2B |= _BV(CS20);
+    pinMode(pin, OUTPUT);
+    // ピンのポートを求める (digitalWrite の表を使う代わりに一度書いてみる)
+    static sim::Reg8 *const PORTS[] = { &PORTE, &PORTE, &PORTE, &PORTE, &PORTG, &PORTE, &PORTH, &PORTH, &PORTH, &PORTH,
+                                        &PORTB, &PORTB, &PORTB, &PORTB, &PORTJ, &PORTJ, &PORTH, &PORTH, &PORTD, &PORTD,
+                                        &PORTD, &PORTD, &PORTA, &PORTA, &PORTA, &PORTA, &PORTA, &PORTA, &PORTA, &PORTA,
+                                        &PORTC, &PORTC, &PORTC, &PORTC, &PORTC, &PORTC, &PORTC, &PORTC, &PORTD, &PORTG,
+                                        &PORTG, &PORTG, &PORTL, &PORTL, &PORTL, &PORTL, &PORTL, &PORTL, &PORTL, &PORTL,
+                                        &PORTB, &PORTB, &PORTB, &PORTB, &PORTF, &PORTF, &PORTF, &PORTF, &PORTF, &PORTF,
+                                        &PORTF, &PORTF, &PORTK, &PORTK, &PORTK, &PORTK, &PORTK, &PORTK, &PORTK, &PORTK };
+    static const uint8_t BITS[] = { 0, 1, 4, 5, 5, 3, 3, 4, 5, 6, 4, 5, 6, 7, 1, 0, 1, 0, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5,
+                                    6, 7, 7, 6, 5, 4, 3, 2, 1, 0, 7, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 3, 2, 1, 0, 0, 1,
+                                    2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 };
+    tone_port = PORTS[pin];
+    tone_mask = (uint8_t) (1 << BITS[pin]);
+  }
+  // 8bit に収まる分周を探す
+  static const uint16_t PRESCALE[] = { 1, 8, 32, 64, 128, 256, 1024 };
+  uint32_t ocr = 0;
+  uint8_t cs = 1;
+  for (uint8_t i = 0; i < 7; i++) {
+    ocr = F_CPU / frequency / 2 / PRESCALE[i] - 1;
+    cs = i + 1;
+    if (ocr <= 255) break;
+  }
+  TCCR2B = (uint8_t) ((TCCR2B & 0xF8) | cs);
+  toggle_count = duration > 0 ? (long) (2UL * frequency * duration / 1000UL) : -1;
+  OCR2A = (uint8_t) ocr;
+  TIMSK2 |= _BV(OCIE2A);
+}
+
+void noTone(const uint8_t pin) {
+  sim::charge(40);
+  TIMSK2 &= (uint8_t) ~_BV(OCIE2A);
+  tone_pin = 255;
+  digitalWrite(pin, LOW);
+}
+
+ISR(TIMER2_COMPA_vect) {
+  sim::charge(20);
+  if (toggle_count != 0) {
+    *tone_port ^= tone_mask;
+    if (toggle_count > 0) toggle_count--;
+  } else {
+    TIMSK2 &= (uint8_t) ~_BV(OCIE2A);
+    *tone_port &= (uint8_t) ~tone_mask;
+    tone_pin = 255;
+  }
+}
@@ -0,0 +1,239 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 複数の基板に同時に自己診断をさせ、結果をまとめる
+//
+//   inspect_boards [--baud 速度] [--cycles 回数] [--auto] [--timeout 秒] ポート...
+//
+// 例: inspect_boards /dev/ttyACM0 /dev/ttyACM1 > report.csv
+//     inspector_sim --pty /tmp/board1 --realtime --seconds 60 --script input.txt &
+//     inspect_boards --auto /tmp/board1 /tmp/board2
+// 各基板に mono2025.h の commandService() の手順で hello, stream 0 を送ってから test を cycles 回繰り返す。
+// ポートごとにスレッドは作らず、poll() で全ポートを1つのループで待つ。
+// 基板ごとの合否・1回の時間を CSV で標準出力に、全体の処理量を '#' の行で出力する。
+
+#include "port.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace tools;
+
+// 応答の無い時に hello を送り直す間隔 [s]
+const double HELLO_RETRY = 1.0;
+
+enum State { HELLO, READY, TESTING, DONE, FAILED };
+
+struct Board {
+  std::string port;
+  int fd = -1;
+  State state = HELLO;
+  std::string rx;
+  // 今の段階の期限と、hello を送った時刻・test を送った時刻 [s]
+  double deadline = 0.0;
+  double hello_at = 0.0;
+  double test_at = 0.0;
+  int cycles = 0;
+  int passes = 0;
+  int fails = 0;
+  std::vector<double> times;
+  // 不合格だった項目と回数
+  std::map<std::string, int> failed_stages;
+  std::string error;
+};
+
+void send(Board &board, const char *line) {
+  const size_t size = strlen(line);
+  // 1行は短いので書ききれなければ失敗とする
+  if (write(board.fd, line, size) != (ssize_t) size) {
+    board.state = FAILED;
+    board.error = std::string("write: ") + strerror(errno);
+  }
+}
+
+// 1行の応答を処理
+void handleLine(Board &board, const std::string &line, const int cycles, const bool automatic, const double timeout) {
+  const double now = hostSeconds();
+  if (board.state == HELLO) {
+    int version = 0;
+    if (sscanf(line.c_str(), "hello,mono2025,%d", &version) != 1) return;
+    if (version != COMMAND_VERSION) {
+      board.state = FAILED;
+      board.error = "protocol version " + std::to_string(version);
+      return;
+    }
+    board.state = READY;
+  }
+  if (board.state == TESTING) {
+    char stage[16], result[8];
+    if (sscanf(line.c_str(), "%15[^,],%7[^,],", stage, result) == 2 && !strcmp(result, "fail") && strcmp(stage, "selftest")) {
+      board.failed_stages[stage]++;
+    }
+    if (!strncmp(line.c_str(), "selftest,pass,", 14)) board.passes++;
+    else if (!strncmp(line.c_str(), "selftest,fail,", 14)) board.fails++;
+    if (line != "ok,test") return;
+    board.times.push_back(now - board.test_at);
+    board.state = READY;
+  }
+  if (board.state == READY) {
+    if (board.cycles >= cycles) {
+      board.state = DONE;
+      return;
+    }
+    board.cycles++;
+    board.test_at = now;
+    board.deadline = now + timeout;
+    board.state = TESTING;
+    send(board, automatic ? "test auto\n" : "test\n");
+  }
+}
+
+// 受信したバイト列からフレームを飛ばして行を取り出す
+void receive(Board &board, const int cycles, const bool automatic, const double timeout) {
+  char buf[512];
+  ssize_t n;
+  while ((n = read(board.fd, buf, sizeof(buf))) > 0) board.rx.append(buf, (size_t) n);
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+    board.state = FAILED;
+    board.error = n == 0 ? "closed" : std::string("read: ") + strerror(errno);
+    return;
+  }
+  while (!board.rx.empty() && board.state != DONE && board.state != FAILED) {
+    const long frame = frameSize(board.rx);
+    if (frame == 0) break;
+    if (frame > 0) {
+      board.rx.erase(0, (size_t) frame);
+      continue;
+    }
+    std::string line;
+    if (!takeLine(board.rx, line)) break;
+    if (!line.empty()) handleLine(board, line, cycles, automatic, timeout);
+  }
+}
+
+void usage() {
+  fprintf(stderr, "usage: inspect_boards [--baud N] [--cycles N] [--auto] [--timeout S] PORT...\n");
+  exit(2);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  long baud = 1000000;
+  int cycles = 1;
+  bool automatic = false;
+  double timeout = 30.0;
+  std::vector<Board> boards;
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    const bool has = i + 1 < argc;
+    if (!strcmp(a, "--baud") && has) baud = atol(argv[++i]);
+    else if (!strcmp(a, "--cycles") && has) cycles = atoi(argv[++i]);
+    else if (!strcmp(a, "--auto")) automatic = true;
+    else if (!strcmp(a, "--timeout") && has) timeout = atof(argv[++i]);
+    else if (a[0] == '-') usage();
+    else {
+      boards.emplace_back();
+      boards.back().port = a;
+    }
+  }
+  const speed_t speed = baudConstant(baud);
+  if (boards.empty() || cycles < 1 || speed == B0) usage();
+
+  const double start = hostSeconds();
+  for (Board &board : boards) {
+    board.fd = openPort(board.port.c_str(), speed);
+    if (board.fd < 0) {
+      board.state = FAILED;
+      board.error = std::string("open: ") + strerror(errno);
+      continue;
+    }
+    // 書きかけの行を捨ててからテレメトリーを止め、版を確かめる
+    send(board, "\nstream 0\nhello\n");
+    board.hello_at = start;
+    board.deadline = start + timeout;
+  }
+
+  std::vector<struct pollfd> fds;
+  std::vector<Board *> polled;
+  for (;;) {
+    fds.clear();
+    polled.clear();
+    for (Board &board : boards) {
+      if (board.state == DONE || board.state == FAILED) continue;
+      fds.push_back({ board.fd, POLLIN, 0 });
+      polled.push_back(&board);
+    }
+    if (fds.empty()) break;
+    if (poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) {
+      perror("poll");
+      return 2;
+    }
+    const double now = hostSeconds();
+    for (size_t i = 0; i < fds.size(); i++) {
+      Board &board = *polled[i];
+      if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) receive(board, cycles, automatic, timeout);
+      if (board.state == HELLO && now - board.hello_at >= HELLO_RETRY) {
+        send(board, "hello\n");
+        board.hello_at = now;
+      }
+      if ((board.state == HELLO || board.state == TESTING) && now >= board.deadline) {
+        board.error = board.state == HELLO ? "no response" : "timeout";
+        board.state = FAILED;
+      }
+    }
+  }
+  const double elapsed = hostSeconds() - start;
+
+  // 基板ごと
+  printf("board,port,cycles,pass,fail,cycle_mean_s,cycle_min_s,cycle_max_s,failed_stages,error\n");
+  int total_cycles = 0, total_pass = 0, total_fail = 0, broken = 0;
+  for (size_t i = 0; i < boards.size(); i++) {
+    const Board &board = boards[i];
+    double sum = 0.0, lo = 0.0, hi = 0.0;
+    for (size_t k = 0; k < board.times.size(); k++) {
+      const double t = board.times[k];
+      sum += t;
+      lo = k ? std::min(lo, t) : t;
+      hi = k ? std::max(hi, t) : t;
+    }
+    const double mean = board.times.empty() ? 0.0 : sum / board.times.size();
+    std::string stages;
+    for (const auto &stage : board.failed_stages) {
+      if (!stages.empty()) stages += ' ';
+      stages += stage.first + ':' + std::to_string(stage.second);
+    }
+    printf("%zu,%s,%zu,%d,%d,%.3f,%.3f,%.3f,%s,%s\n", i + 1, board.port.c_str(), board.times.size(), board.passes,
+           board.fails, mean, lo, hi, stages.c_str(), board.error.c_str());
+    total_cycles += (int) board.times.size();
+    total_pass += board.passes;
+    total_fail += board.fails;
+    if (board.state == FAILED) broken++;
+  }
+  // 全体
+  printf("# boards %zu, unreachable or timed out %d, tests %d, pass %d, fail %d\n", boards.size(), broken, total_cycles,
+         total_pass, total_fail);
+  printf("# elapsed %.2f s, throughput %.1f tests/h\n", elapsed, elapsed > 0 ? total_cycles * 3600.0 / elapsed : 0.0);
+  return (broken || total_fail) ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 道具で共通のシリアルポートと基板の手順
+
+#ifndef TOOLS_PORT_H
+#define TOOLS_PORT_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+
+namespace tools {
+
+// mono2025.h の COMMAND_VERSION とフレームの同期バイトに揃える
+const int COMMAND_VERSION = 1;
+const uint8_t SYNC_1 = 0xA5;
+const uint8_t TELEMETRY_SYNC_2 = 0x5A;
+const uint8_t TRACE_SYNC_2 = 0x5B;
+
+inline double hostSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+inline speed_t baudConstant(const long baud) {
+  switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 500000: return B500000;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 2000000: return B2000000;
+    default: return B0;
+  }
+}
+
+// 生モード・8N1・待たない読み書きで開く (疑似端末では速度は無視される)
+inline int openPort(const char *path, const speed_t speed) {
+  const int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0) return -1;
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  tcflush(fd, TCIFLUSH);
+  return fd;
+}
+
+// CRC-8 (多項式 0x07、初期値 0)
+inline uint8_t crc8(uint8_t crc, const uint8_t data) {
+  crc ^= data;
+  for (int i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x07) : (uint8_t) (crc << 1);
+  return crc;
+}
+
+// 先頭が同期バイト・長さ・データ・CRC のフレームならその長さ、足りなければ 0、違えば -1
+// (2つ目の同期バイトは sync2 に返す)
+inline long frameSize(const std::string &rx, uint8_t *sync2 = nullptr) {
+  const uint8_t *p = (const uint8_t *) rx.data();
+  if (rx.size() < 2) return (rx.size() == 1 && p[0] == SYNC_1) ? 0 : -1;
+  if (p[0] != SYNC_1 || (p[1] != TELEMETRY_SYNC_2 && p[1] != TRACE_SYNC_2)) return -1;
+  if (rx.size() < 3) return 0;
+  const size_t size = 3 + p[2] + 1;
+  if (rx.size() < size) return 0;
+  uint8_t crc = 0;
+  for (size_t i = 2; i < size - 1; i++) crc = crc8(crc, p[i]);
+  if (crc != p[size - 1]) return -1;
+  if (sync2) *sync2 = p[1];
+  return (long) size;
+}
+
+// フレームを除いた受信から1行を取り出す (無ければ false。接続直後の途中のフレームの残りは捨てる)
+inline bool takeLine(std::string &rx, std::string &line) {
+  const size_t end = rx.find('\n');
+  if (end == std::string::npos) {
+    // 改行の来ないゴミは捨てる
+    if (rx.size() > 256) rx.clear();
+    return false;
+  }
+  line = rx.substr(0, end);
+  rx.erase(0, end + 1);
+  if (!line.empty() && line.back() == '\r') line.pop_back();
+  const size_t text = line.find_first_of("abcdefghijklmnopqrstuvwxyz");
+  line = text == std::string::npos ? std::string() : line.substr(text);
+  return true;
+}
+
+} // namespace tools
+
+#endif // TOOLS_PORT_H
@@ -0,0 +1,157 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// telemetryBegin() のバイナリのフレームを CSV に変換する
+//
+//   telemetry_decode [ファイル|-]
+//
+// 例: stty -F /dev/ttyACM0 1000000 raw && telemetry_decode /dev/ttyACM0 > log.csv
+//     inspector_sim --serial-in on.txt --serial-out - --quiet | telemetry_decode > log.csv  (on.txt は "telemetry on" の1行)
+// 同期バイトと CRC で区切りを探すので、途中から読み始めても良い。
+// 番号の抜けは lost 列に出し、終了時に合計を標準エラーに出力する。
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+// Inspector/mono2025.h の TelemetryPayload と揃える
+const uint8_t SYNC_1 = 0xA5;
+const uint8_t SYNC_2 = 0x5A;
+const uint8_t VERSION = 1;
+const size_t BAR_COUNT = 10;
+const size_t PAYLOAD_SIZE = 1 + 2 + 4 + 1 + 2 * 3 + 1 + 1 + 8 + 2 * BAR_COUNT + 2 + 2 + 4 + 1;
+const char *const INPUTS[] = { "tl", "tr", "ll", "lr", "rl", "rr", "toggle", "photo" };
+const char *const FLAGS[] = { "buzzing", "servo_reached", "dc_settled", "bar_fading", "stepper_moving" };
+
+// CRC-8 (多項式 0x07、初期値 0)
+uint8_t crc8(uint8_t crc, const uint8_t data) {
+  crc ^= data;
+  for (int i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x07) : (uint8_t) (crc << 1);
+  return crc;
+}
+
+// リトルエンディアンで順に読む
+struct Reader {
+  const uint8_t *p;
+  uint8_t u8() { return *p++; }
+  uint16_t u16() {
+    const uint16_t v = (uint16_t) (p[0] | p[1] << 8);
+    p += 2;
+    return v;
+  }
+  uint32_t u32() {
+    const uint32_t v = (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+    p += 4;
+    return v;
+  }
+};
+
+void header() {
+  printf("seq,time_ms,lost");
+  for (const char *name : INPUTS) printf(",%s", name);
+  printf(",pot,joy_x,joy_y,seg,motor,matrix");
+  for (size_t i = 0; i < BAR_COUNT; i++) printf(",bar%zu", i + 1);
+  printf(",servo_us,rpm,stepper");
+  for (const char *name : FLAGS) printf(",%s", name);
+  printf("\n");
+}
+
+// 1フレームを1行に (戻り値は番号)
+uint16_t row(const uint8_t *payload, const unsigned lost) {
+  Reader r { payload + 1 };
+  const uint16_t seq = r.u16();
+  const uint32_t time = r.u32();
+  const uint8_t input = r.u8();
+  printf("%u,%.1f,%u", seq, time / 10.0, lost);
+  for (size_t i = 0; i < sizeof(INPUTS) / sizeof(INPUTS[0]); i++) printf(",%d", input >> i & 1);
+  const uint16_t pot = r.u16();
+  const uint16_t joy_x = r.u16();
+  const uint16_t joy_y = r.u16();
+  const uint8_t seg = r.u8();
+  const uint8_t motor = r.u8();
+  printf(",%u,%u,%u,0x%02X,0x%02X,", pot, joy_x, joy_y, seg, motor);
+  // 列ごとの 8bit を 16 進で
+  for (int x = 0; x < 8; x++) printf("%02X", r.u8());
+  for (size_t i = 0; i < BAR_COUNT; i++) {
+    const uint16_t c = r.u16();
+    // RGB565 を 8bit に広げる
+    const unsigned red = (c >> 11) * 255 / 31, green = (c >> 5 & 0x3F) * 255 / 63, blue = (c & 0x1F) * 255 / 31;
+    printf(",#%02X%02X%02X", red, green, blue);
+  }
+  const uint16_t servo = r.u16();
+  const uint16_t rpm = r.u16();
+  const int32_t stepper = (int32_t) r.u32();
+  const uint8_t flags = r.u8();
+  printf(",%u,%u,%ld", servo, rpm, (long) stepper);
+  for (size_t i = 0; i < sizeof(FLAGS) / sizeof(FLAGS[0]); i++) printf(",%d", flags >> i & 1);
+  printf("\n");
+  return seq;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 2) {
+    fprintf(stderr, "usage: telemetry_decode [FILE|-]\n");
+    return 2;
+  }
+  FILE *in = (argc < 2 || !strcmp(argv[1], "-")) ? stdin : fopen(argv[1], "rb");
+  if (!in) {
+    perror(argv[1]);
+    return 2;
+  }
+  header();
+  // 同期バイト2つ・長さ・本体・CRC
+  const size_t frame_size = 3 + PAYLOAD_SIZE + 1;
+  uint8_t buf[4096];
+  size_t size = 0;
+  unsigned long frames = 0, lost_total = 0, garbage = 0;
+  bool first = true;
+  uint16_t expect = 0;
+  size_t n;
+  while ((n = fread(buf + size, 1, sizeof(buf) - size, in)) > 0) {
+    size += n;
+    size_t i = 0;
+    while (size - i >= frame_size) {
+      const uint8_t *f = buf + i;
+      bool ok = f[0] == SYNC_1 && f[1] == SYNC_2 && f[2] == PAYLOAD_SIZE && f[3] == VERSION;
+      if (ok) {
+        uint8_t crc = 0;
+        for (size_t k = 2; k < frame_size - 1; k++) crc = crc8(crc, f[k]);
+        ok = crc == f[frame_size - 1];
+      }
+      // 合わなければ1バイトずらして探し直す
+      if (!ok) {
+        garbage++;
+        i++;
+        continue;
+      }
+      const uint16_t seq = (uint16_t) (f[4] | f[5] << 8);
+      const unsigned lost = first ? 0 : (uint16_t) (seq - expect);
+      lost_total += lost;
+      expect = (uint16_t) (row(f + 3, lost) + 1);
+      first = false;
+      frames++;
+      i += frame_size;
+    }
+    memmove(buf, buf + i, size - i);
+    size -= i;
+  }
+  if (in != stdin) fclose(in);
+  // 最後の途中までのフレームは読み捨てる
+  fprintf(stderr, "frames: %lu, lost: %lu, skipped bytes: %lu, incomplete bytes: %zu\n", frames, lost_total, garbage, size);
+  return 0;
+}
@@ -0,0 +1,314 @@
+/*
+  Copyright 2025 Syuugo
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+      http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// 基板の入力の変化点を記録し、後で同じ時刻で再生する
+//
+//   trace_tool record [--baud 速度] [--seconds 秒] ポート 記録ファイル
+//   trace_tool replay [--baud 速度] [--capture ファイル] ポート 記録ファイル
+//   trace_tool dump 記録ファイル
+//
+// record は trace record を送り、届いた変化点を記録ファイルに書く。(Ctrl-C か秒数で止める)
+// replay は trace replay を送り、基板の空きに合わせて記録ファイルを送る。
+// --capture を付けると再生中の受信 (テレメトリー等) をそのまま保存するので、
+// telemetry_decode で CSV にしてファームウェアの版ごとに比べられる。
+// dump は記録ファイルの変化点を1行ずつ文字で出力する。
+// 記録ファイルは mono2025.h の TraceKind の形式 (最後に TRACE_END) で、実機とシミュレーターで共通。
+
+#include "port.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace tools;
+
+// mono2025.h の TraceKind に揃える
+enum TraceKind { TRACE_LEVEL, TRACE_POT, TRACE_JOY_X, TRACE_JOY_Y, TRACE_END = 7 };
+const unsigned TRACE_WAIT_LONG = 31;
+const char *const KINDS[] = { "level", "pot", "joy_x", "joy_y" };
+
+volatile sig_atomic_t interrupted = 0;
+
+void onSignal(int) {
+  interrupted = 1;
+}
+
+int port_fd = -1;
+std::string rx;
+
+bool sendAll(const void *data, size_t size) {
+  const char *p = (const char *) data;
+  while (size) {
+    const ssize_t n = write(port_fd, p, size);
+    if (n < 0) {
+      if (errno != EAGAIN && errno != EINTR) return false;
+      struct pollfd fd = { port_fd, POLLOUT, 0 };
+      poll(&fd, 1, 100);
+      continue;
+    }
+    p += n;
+    size -= (size_t) n;
+  }
+  return true;
+}
+
+// 受信を待って rx に足す (capture があれば受信をそのまま書く)
+bool receive(const int timeout_ms, FILE *capture = nullptr) {
+  struct pollfd fd = { port_fd, POLLIN, 0 };
+  if (poll(&fd, 1, timeout_ms) <= 0) return true;
+  char buf[1024];
+  const ssize_t n = read(port_fd, buf, sizeof(buf));
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) return false;
+  if (n > 0) {
+    rx.append(buf, (size_t) n);
+    if (capture) fwrite(buf, 1, (size_t) n, capture);
+  }
+  return true;
+}
+
+// rx から記録のフレームと行を取り出す (記録のデータは trace へ)
+bool next(std::string &line, std::vector<uint8_t> *trace) {
+  while (!rx.empty()) {
+    uint8_t sync2 = 0;
+    const long frame = frameSize(rx, &sync2);
+    if (frame == 0) return false;
+    if (frame > 0) {
+      if (sync2 == TRACE_SYNC_2 && trace) trace->insert(trace->end(), rx.begin() + 3, rx.begin() + frame - 1);
+      rx.erase(0, (size_t) frame);
+      continue;
+    }
+    if (!takeLine(rx, line)) return false;
+    if (!line.empty()) return true;
+  }
+  return false;
+}
+
+// 行 prefix が来るまで待つ (来れば残りを rest に)
+bool expect(const char *prefix, std::string *rest, const double timeout, std::vector<uint8_t> *trace = nullptr) {
+  const double end = hostSeconds() + timeout;
+  std::string line;
+  while (hostSeconds() < end) {
+    while (next(line, trace)) {
+      if (!line.compare(0, strlen(prefix), prefix)) {
+        if (rest) *rest = line.substr(strlen(prefix));
+        return true;
+      }
+      if (!line.compare(0, 6, "error,")) return false;
+    }
+    if (!receive(100)) return false;
+  }
+  return false;
+}
+
+// 基板の応答を確かめてテレメトリーを止める (開いた時に基板がリセットされても待つ)
+bool connect() {
+  for (int i = 0; i < 5; i++) {
+    if (!sendAll("\nstream 0\nhello\n", 16)) return false;
+    if (expect("hello,mono2025,", nullptr, 1.0)) return expect("ok,hello", nullptr, 1.0);
+  }
+  return false;
+}
+
+int record(const char *path, const double seconds) {
+  FILE *out = fopen(path, "wb");
+  if (!out) {
+    perror(path);
+    return 2;
+  }
+  std::vector<uint8_t> trace;
+  if (!sendAll("trace record\n", 13) || !expect("ok,trace", nullptr, 2.0, &trace)) {
+    fprintf(stderr, "trace record: no response\n");
+    return 1;
+  }
+  fprintf(stderr, "recording (Ctrl-C to stop)\n");
+  const double start = hostSeconds();
+  std::string line;
+  while (!interrupted && (seconds <= 0 || hostSeconds() - start < seconds)) {
+    if (!receive(100)) break;
+    while (next(line, &trace)) {
+    }
+  }
+  std::string lost;
+  if (!sendAll("trace stop\n", 11) || !expect("trace,lost,", &lost, 2.0, &trace) || !expect("ok,trace", nullptr, 2.0, &trace)) {
+    fprintf(stderr, "trace stop: no response\n");
+    return 1;
+  }
+  trace.push_back(TRACE_END << 5);
+  fwrite(trace.data(), 1, trace.size(), out);
+  fclose(out);
+  fprintf(stderr, "%zu bytes in %.1f s, lost %s\n", trace.size(), hostSeconds() - start, lost.c_str());
+  return atoi(lost.c_str()) ? 1 : 0;
+}
+
+int replay(const char *path, const char *capture_path) {
+  FILE *in = fopen(path, "rb");
+  if (!in) {
+    perror(path);
+    return 2;
+  }
+  std::vector<uint8_t> trace;
+  int c;
+  while ((c = fgetc(in)) != EOF) trace.push_back((uint8_t) c);
+  fclose(in);
+  FILE *capture = nullptr;
+  if (capture_path) {
+    capture = fopen(capture_path, "wb");
+    if (!capture) {
+      perror(capture_path);
+      return 2;
+    }
+  }
+  // 再生中の出力を残すならテレメトリーを流す
+  const std::string command = capture ? "stream 1\ntrace replay\n" : "trace replay\n";
+  if (!sendAll(command.data(), command.size())) return 1;
+  // 基板が空きを知らせた分だけ送る
+  size_t sent = 0;
+  long credit = 0;
+  std::string line, lost;
+  bool ended = false;
+  const double start = hostSeconds();
+  while (!ended && !interrupted) {
+    if (!receive(100, capture)) break;
+    while (next(line, nullptr)) {
+      if (!line.compare(0, 13, "trace,credit,")) credit += atol(line.c_str() + 13);
+      if (!line.compare(0, 10, "trace,end,")) {
+        lost = line.substr(10);
+        ended = true;
+      }
+    }
+    const size_t size = std::min((size_t) std::max(credit, 0L), trace.size() - sent);
+    if (size && sendAll(trace.data() + sent, size)) {
+      sent += size;
+      credit -= (long) size;
+    }
+  }
+  if (interrupted && !ended) {
+    // 途中で止める時も TRACE_END で基板をコマンドに戻す
+    const uint8_t end = TRACE_END << 5;
+    sendAll(&end, 1);
+  }
+  if (capture) {
+    // 再生後の少しの間も残す
+    const double tail = hostSeconds() + 0.2;
+    while (hostSeconds() < tail) receive(50, capture);
+    fclose(capture);
+  }
+  fprintf(stderr, "%zu bytes in %.1f s, late ticks %s\n", sent, hostSeconds() - start, ended ? lost.c_str() : "?");
+  return ended && !atoi(lost.c_str()) ? 0 : 1;
+}
+
+// 可変長の数を読む
+bool number(const std::vector<uint8_t> &trace, size_t &at, unsigned long &value) {
+  value = 0;
+  for (int shift = 0; at < trace.size(); shift += 7) {
+    const uint8_t data = trace[at++];
+    value |= (unsigned long) (data & 0x7F) << shift;
+    if (!(data & 0x80)) return true;
+  }
+  return false;
+}
+
+int dump(const char *path) {
+  FILE *in = fopen(path, "rb");
+  if (!in) {
+    perror(path);
+    return 2;
+  }
+  std::vector<uint8_t> trace;
+  int c;
+  while ((c = fgetc(in)) != EOF) trace.push_back((uint8_t) c);
+  fclose(in);
+  printf("time_ms,kind,value\n");
+  unsigned long time = 0;
+  unsigned adc[3] = { 0, 0, 0 };
+  size_t at = 0;
+  while (at < trace.size()) {
+    const uint8_t first = trace[at++];
+    unsigned long wait = first & TRACE_WAIT_LONG, more = 0;
+    if (wait == TRACE_WAIT_LONG && !number(trace, at, more)) break;
+    time += wait + more;
+    const int kind = first >> 5;
+    if (kind == TRACE_END) {
+      printf("%.1f,end,\n", time / 10.0);
+      return 0;
+    }
+    if (kind == TRACE_LEVEL) {
+      if (at >= trace.size()) break;
+      printf("%.1f,level,0x%02X\n", time / 10.0, trace[at++]);
+      continue;
+    }
+    unsigned long zigzag;
+    if (kind > TRACE_JOY_Y || !number(trace, at, zigzag)) break;
+    const long delta = (zigzag & 1) ? -(long) (zigzag >> 1) - 1 : (long) (zigzag >> 1);
+    adc[kind - TRACE_POT] += (unsigned) delta;
+    printf("%.1f,%s,%u\n", time / 10.0, KINDS[kind], adc[kind - TRACE_POT] & 0xFFFF);
+  }
+  fprintf(stderr, "%s: truncated\n", path);
+  return 1;
+}
+
+void usage() {
+  fprintf(stderr,
+          "usage: trace_tool record [--baud N] [--seconds S] PORT FILE\n"
+          "       trace_tool replay [--baud N] [--capture FILE] PORT FILE\n"
+          "       trace_tool dump FILE\n");
+  exit(2);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) usage();
+  const char *mode = argv[1];
+  long baud = 1000000;
+  double seconds = 0.0;
+  const char *capture = nullptr;
+  std::vector<const char *> args;
+  for (int i = 2; i < argc; i++) {
+    const char *a = argv[i];
+    const bool has = i + 1 < argc;
+    if (!strcmp(a, "--baud") && has) baud = atol(argv[++i]);
+    else if (!strcmp(a, "--seconds") && has) seconds = atof(argv[++i]);
+    else if (!strcmp(a, "--capture") && has) capture = argv[++i];
+    else if (a[0] == '-') usage();
+    else args.push_back(a);
+  }
+  if (!strcmp(mode, "dump")) {
+    if (args.size() != 1) usage();
+    return dump(args[0]);
+  }
+  const speed_t speed = baudConstant(baud);
+  if (args.size() != 2 || speed == B0 || (strcmp(mode, "record") && strcmp(mode, "replay"))) usage();
+  port_fd = openPort(args[0], speed);
+  if (port_fd < 0) {
+    perror(args[0]);
+    return 2;
+  }
+  signal(SIGINT, onSignal);
+  if (!connect()) {
+    fprintf(stderr, "%s: no response\n", args[0]);
+    return 1;
+  }
+  const int result = !strcmp(mode, "record") ? record(args[1], seconds) : replay(args[1], capture);
+  close(port_fd);
+  return result;
+}